@@ -17,30 +17,633 @@
  */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+
+/**
+ * Containers pack many instances, or many solutions, into one file:
+ * a header, the records one after the other, and an index of record offsets.
+ * A record is a myrecord_header, the name of the instance padded to 8 bytes,
+ * and the payload: the x coordinates then the y coordinates of the points
+ * (int32), or the lines (myline). All numbers are in native byte order.
+ */
+#define CONTAINER_MAGIC_SIZE 8
+#define INSTANCES_MAGIC "SEPINST1"
+#define SOLUTIONS_MAGIC "SEPSOLN1"
+#define CONTAINER_NAME_MAX 1023
+
+/**
+ * A cache entry holds CACHE_MAGIC, the number of points, the number of
+ * lines, the rank signature and the indices of the chosen candidate lines.
+ */
+#define CACHE_MAGIC 0x31435352u
+#define CACHE_NO_SPLIT 0xffffffffu
+
+/**
+ * Every block handed out by the arena starts on a cache line, which is also
+ * enough for the widest vector loads of the counting kernels.
+ */
+#define ARENA_ALIGN 64
+
+/**
+ * Text files are read in chunks of at least this many bytes.
+ */
+#define TEXT_CHUNK 65536
+
+/**
+ * The differential test solves instances of at most REF_MAX_POINTS points,
+ * as the reference is O(n^4), drawn from NUM_SHAPES shapes, with at most
+ * MAX_CONFIGS configurations of the solver.
+ */
+#define REF_MAX_POINTS 100
+#define NUM_SHAPES 7
+#define MAX_CONFIGS 24
 
 /**
- * 100 is the maximum number of points.
- * 100 is also the maximum index of an input instance file.
+ * The number of partitions the exact search remembers, a power of two, and
+ * the most points a bare --exact searches: the search grows exponentially
+ * and past a few dozen random points it is rarely proven in seconds.
  */
-#define MAX_POINTS 100
+#define EXACT_MEMO_SIZE (1 << 20)
+#define EXACT_DEFAULT_MAX 30
+
+/**
+ * An estimated gain is trusted once this many sampled points have links
+ * across the line; with fewer the interval of the sample does not hold.
+ */
+#define APPROX_MIN_SEEN 16
+
+/**
+ * The loops that evaluate candidates or link points read the clock once
+ * every BUDGET_CHECK_EVERY iterations when there is a budget.
+ */
+#define BUDGET_CHECK_EVERY 16
 
 typedef struct Line {
     int axis;
     float coord;
 } myline;
 
-typedef struct Point mypoint;
-struct Point {
+/**
+ * The links of a point are kept as a bitset indexed by point id, so that
+ * counting and breaking links between two groups of points is a bitwise
+ * AND plus a population count over whole words.
+ */
+typedef uint64_t myword;
+#define WORD_BITS 64
+
+/**
+ * A counting kernel works on one row of links and a mask of points on the
+ * other side of a line.
+ * count_links returns the number of bits set in both.
+ * cut_links does the same and also clears those bits from the row.
+ */
+typedef struct Kernel {
+    const char *name;
+    int (*supported)(void);
+    unsigned int (*count_links)(const myword *row, const myword *mask, unsigned int words);
+    unsigned int (*cut_links)(myword *row, const myword *mask, unsigned int words);
+} mykernel;
+
+/**
+ * A block malloc'ed when the arena ran out of room in the middle of an
+ * instance; the data follows the header.
+ */
+typedef struct Block myblock;
+struct Block {
+    myblock *next;
+};
+
+/**
+ * All per-instance solver memory comes from one arena. Allocating bumps an
+ * offset and restore() resets it in O(1). When an instance needs more than
+ * the arena holds, the rest is served from overflow blocks and the arena is
+ * regrown to the high-water mark on the next reset, so a batch settles at
+ * zero allocations per instance.
+ */
+typedef struct Arena {
+    char *raw;
+    char *base;
+    size_t size;
+    size_t used;
+    size_t peak;
+    myblock *overflow;
+    unsigned int num_mallocs;
+} myarena;
+
+/**
+ * One input file to solve and the file its solution is written to.
+ * name is the file name part of input, used in messages.
+ */
+typedef struct Job {
+    char *input;
+    char *output;
+    const char *name;
+} myjob;
+
+/**
+ * A text file read into memory in one go and parsed in place, which is much
+ * faster than fscanf on files of millions of points. The buffer only grows
+ * and is reused by the next file read into the same struct.
+ */
+typedef struct Text {
+    char *data;
+    size_t size;
+    size_t capacity;
+    size_t pos;
+} mytext;
+
+/**
+ * An instance as read from an input file, before it is loaded into the
+ * solver. The point buffers only grow and are reused by the next instance
+ * read into the same struct.
+ */
+typedef struct Instance {
+    const myjob *job;
+    int status;
+    unsigned int num_points;
+    unsigned int capacity;
+    int *x;
+    int *y;
+    mytext text;
+} myinstance;
+
+/**
+ * An open-addressing hash set of the cells occupied by points. A cell is
+ * named by the slabs of the point between the lines of each axis, packed
+ * into one key by cell_key(). Keys are stored plus one, so that zero marks an
+ * empty slot; ids holds the point that occupies the cell.
+ */
+typedef struct CellSet {
+    uint64_t *keys;
+    int *ids;
+    size_t mask;
+} mycellset;
+
+static inline uint64_t cell_key(unsigned int v_slab, unsigned int h_slab) {
+    return ((uint64_t)v_slab << 32) | h_slab;
+}
+
+/**
+ * The finalizer of MurmurHash3, so that neighbouring cells spread over the table.
+ */
+static inline size_t cell_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+/**
+ * A wavelet matrix over the y-ranks of the points in x-rank order, which
+ * counts the points of any rectangle of ranks in O(log n) with n log n bits.
+ * Level l holds bit levels - 1 - l of every value, in the order the values
+ * have after being stably partitioned by the higher bits; ones[l * (words + 1) + w]
+ * counts the ones of level l before word w and zeros[l] the zeros of level l.
+ */
+typedef struct Wavelet {
+    unsigned int n;
+    unsigned int levels;
+    unsigned int words;
+    myword *bits;
+    unsigned int *ones;
+    unsigned int *zeros;
+} mywavelet;
+
+/**
+ * The committed lines of a solved instance, copied out of the solver so
+ * that they can be written while the next instance is solved.
+ */
+typedef struct Solution {
+    const myjob *job;
+    unsigned int num_lines;
+    unsigned int capacity;
+    myline *lines;
+} mysolution;
+
+/**
+ * A solved point set kept in memory while points are inserted and deleted.
+ * The lines of each axis are kept sorted, slab[a][i] is the slab of point i
+ * between the lines of axis a and cells maps every occupied cell to its
+ * point, so that updates are located and repaired without solving again.
+ * Deleted points keep their ids until the next full solve renumbers the
+ * live ones; merge is scratch space of dynamic_line_needed().
+ */
+typedef struct Dynamic {
+    int *x;
+    int *y;
+    char *alive;
+    unsigned int *slab[2];
+    unsigned int num_points;
+    unsigned int num_alive;
+    unsigned int capacity;
+    double *coords[2];
+    unsigned int num_coords[2];
+    unsigned int coords_capacity[2];
+    mycellset cells;
+    mycellset merge;
+    size_t cell_slots;
+    double threshold;
+    unsigned int solved_lines;
+    unsigned int num_solves;
+    unsigned int lines_added;
+    unsigned int lines_removed;
+} mydynamic;
+
+/**
+ * A solution loaded for point location. coords holds the lines of each axis
+ * sorted, eytz the same lines in Eytzinger order, from index 1, with slab
+ * the sorted index of each, and cells maps every occupied cell to its point.
+ */
+typedef struct Locator {
+    const myinstance *inst;
+    double *coords[2];
+    unsigned int num_coords[2];
+    double *eytz[2];
+    unsigned int *slab[2];
+    mycellset cells;
+} mylocator;
+
+typedef struct ContainerHeader {
+    char magic[CONTAINER_MAGIC_SIZE];
+    uint64_t count;
+    uint64_t index_offset;
+    uint64_t reserved;
+} mycontainer_header;
+
+/**
+ * count is the number of points or lines in the payload.
+ */
+typedef struct RecordHeader {
+    uint32_t count;
+    uint32_t name_len;
+} myrecord_header;
+
+/**
+ * A container mapped into memory for reading.
+ */
+typedef struct Container {
+    const char *data;
+    size_t size;
+    uint64_t count;
+    const uint64_t *index;
+} mycontainer;
+
+/**
+ * A container being written; the offsets of the records written so far
+ * become the index when it is closed.
+ */
+typedef struct ContainerWriter {
+    FILE *file;
+    char magic[CONTAINER_MAGIC_SIZE];
+    uint64_t pos;
+    uint64_t *offsets;
+    uint64_t count;
+    uint64_t capacity;
+} mywriter;
+
+/**
+ * A point of the reference greedy, linked to the other points by pointers.
+ */
+typedef struct RefPoint myrefpoint;
+struct RefPoint {
     int id;
     int x;
     int y;
-    mypoint **connections;
+    myrefpoint *connections[REF_MAX_POINTS];
+};
+
+/**
+ * A fixed set of threads running batches of numbered tasks, see pool_run().
+ */
+typedef struct Pool mypool;
+
+typedef struct Worker {
+    pthread_t thread;
+    mypool *pool;
+    int id;
+} myworker;
+
+struct Pool {
+    myworker *workers;
+    int num_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    void (*task)(void *arg, unsigned int index, int worker);
+    void *arg;
+    unsigned int next;
+    unsigned int count;
+    unsigned int finished;
+    int stop;
 };
 
+/**
+ * A configuration of the solver compared with the reference by the
+ * differential test. Besides the kernel, storage and selection of the
+ * greedy it can take a path that must give the same lines: one restart on
+ * a pool of threads, a beam of one state looking one line ahead, or a
+ * second solve answered from the cache.
+ */
+typedef struct Config {
+    char name[32];
+    const mykernel *kernel;
+    int storage;
+    int select_tree;
+    int threads;
+    mypool *pool;
+    int beam;
+    int cache;
+} myconfig;
+
+/**
+ * The best solution a pool thread found among the restarts it ran.
+ * index is the restart it came from, -1 before the first one; stopped_early
+ * tells whether it leaves points sharing cells.
+ */
+typedef struct Restart {
+    mysolution sol;
+    int index;
+    unsigned int pruned;
+    int out_of_time;
+    int stopped_early;
+} myrestart;
+
+/**
+ * The restarts of one instance: the best solution of every pool thread and
+ * the number of lines of every restart.
+ */
+typedef struct Restarts {
+    const myinstance *inst;
+    myrestart *best;
+    unsigned int *num_lines;
+} myrestarts;
+
+/**
+ * The coarse level of the two-level solver. Per axis, bounds holds the
+ * boundaries between buckets and bucket the bucket of every point;
+ * prefix[i * (buckets[H] + 1) + j] counts the points of the buckets below i
+ * and j, and starts the buckets where the slabs of the committed boundaries
+ * start, ending with the number of buckets.
+ */
+typedef struct Coarse {
+    unsigned int buckets[2];
+    double *bounds[2];
+    unsigned int *bucket[2];
+    unsigned int *prefix;
+    unsigned int *starts[2];
+    unsigned int num_slabs[2];
+} mycoarse;
+
+/**
+ * A state of the beam search: the cell of every point under the lines
+ * committed so far, the points of every cell, the pairs still sharing a
+ * cell, the last node of the history of its lines and a hash of the set of
+ * its lines, equal for the same lines committed in another order.
+ */
+typedef struct BeamState {
+    int *cell;
+    unsigned int *size;
+    unsigned int num_cells;
+    unsigned long long pairs;
+    int node;
+    uint64_t hash;
+} mybeamstate;
+
+/**
+ * A child of a beam state, not yet copied out of it: the line committed in
+ * it, the pairs it leaves and how the greedy lookahead from it went, the
+ * lines it took and the pairs left after them. line is -1 for no child.
+ */
+typedef struct BeamChild {
+    unsigned int parent;
+    int line;
+    unsigned long long after;
+    unsigned int steps;
+    unsigned long long pairs;
+} mybeamchild;
+
+/**
+ * A node of the history of the beam: a committed line and the node of the
+ * lines committed before it, -1 for none.
+ */
+typedef struct BeamNode {
+    int parent;
+    int line;
+} mybeamnode;
+
+/**
+ * The scratch memory of one thread of the beam search.
+ */
+typedef struct BeamScratch {
+    int *cell;
+    unsigned int *size;
+    unsigned int *left;
+    int *new_cell;
+    long long *gain[2];
+} mybeamscratch;
+
+/**
+ * The beam search over one instance. Per axis, order lists the points by
+ * rank; split[k] is the rank after which candidate k lies, -1 if it splits
+ * nothing. states are the current beam and next the one being built from
+ * the kept children.
+ */
+typedef struct Beam {
+    unsigned int n;
+    unsigned int num_candidates;
+    const int *order[2];
+    const int *split;
+    unsigned int width;
+    unsigned int depth;
+    mybeamstate *states;
+    mybeamstate *next;
+    unsigned int num_states;
+    mybeamchild *children;
+    mybeamchild *kept;
+    unsigned int num_kept;
+    mybeamscratch *scratch;
+    mybeamnode *nodes;
+    unsigned int num_nodes;
+    unsigned int nodes_capacity;
+} mybeam;
+
+/**
+ * The state of the local search over a solution. Per axis, bounds holds
+ * the ranks where the slabs of its lines start, from 0 up to the number of
+ * points; a slab is named by its start, so removing a line only renames the
+ * points of the slab it closed. gone holds the starts of the lines a move
+ * takes out, -1 if none, and pairs the points a move leaves sharing cells.
+ */
+typedef struct Local {
+    const int *order[2];
+    const int *rank[2];
+    const int *sorted[2];
+    int *bounds[2];
+    unsigned int num_bounds[2];
+    int gone[2][2];
+    mycellset cells;
+    int *pairs;
+    unsigned int num_pairs;
+    uint64_t rng;
+} mylocal;
+
+/**
+ * A node of the exact search: the candidate lines committed on the way to
+ * it, as indices into all_lines.
+ */
+typedef struct ExactNode {
+    unsigned int depth;
+    int lines[];
+} myexactnode;
+
+/**
+ * The nodes waiting to be visited by one thread of the exact search.
+ * The thread takes from the tail and other threads steal from the head.
+ */
+typedef struct ExactDeque {
+    pthread_mutex_t lock;
+    myexactnode **nodes;
+    unsigned int head;
+    unsigned int tail;
+    unsigned int capacity;
+} myexactdeque;
+
+/**
+ * Two points sharing a cell, and for each axis the range of ranks
+ * [lo, hi) holding the candidate lines that separate them; cost is the
+ * number of those candidates.
+ */
+typedef struct ExactPair {
+    int p;
+    int q;
+    int lo[2];
+    int hi[2];
+    int cost;
+} myexactpair;
+
+/**
+ * A child of a node: the line it adds, the links that line breaks and the
+ * hash of the partition it leads to.
+ */
+typedef struct ExactChild {
+    uint64_t hash;
+    long long gain;
+    int line;
+} myexactchild;
+
+/**
+ * The shared state of the exact search of one instance.
+ * gaps[a][r] counts the candidates of axis a below rank r that lie between
+ * two distinct coordinates, the only ones valid to commit. pending counts
+ * the nodes not visited yet; the search is over when it drops to zero.
+ * queued counts the nodes waiting in the deques, and threads finding none
+ * wait on idle until nodes are pushed or the search is over.
+ */
+typedef struct Exact {
+    unsigned int n;
+    const int *rank[2];
+    const int *order[2];
+    const int *x_sorted;
+    const int *y_sorted;
+    const char *valid;
+    const int *gaps[2];
+    int num_threads;
+    myexactdeque *deques;
+    long pending;
+    long queued;
+    int num_idle;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle;
+    int stopped;
+    struct timespec start;
+    pthread_mutex_t lock;
+    unsigned int best_count;
+    int *best_lines;
+    pthread_mutex_t memo_lock;
+    uint64_t *memo_keys;
+    unsigned int *memo_depth;
+    size_t memo_mask;
+} myexact;
+
+typedef struct ExactWorker {
+    myexact *e;
+    int id;
+    pthread_t thread;
+    unsigned long long nodes;
+} myexactworker;
+
+/**
+ * The per-thread buffers of the exact search, indexed by point id or by
+ * cell label, and the number of lines of each axis at the current node.
+ */
+typedef struct ExactScratch {
+    unsigned int lines[2];
+    char *cut[2];
+    int *slab[2];
+    int *label;
+    int *size;
+    int *last;
+    int *run;
+    int *mult[2];
+    int *first[2];
+    int *count[2];
+    myexactpair *pairs;
+    const myexactpair **chosen;
+    myexactchild *children;
+    mycellset cells;
+} myexactscratch;
+
+/**
+ * A bounded blocking FIFO of pointers connecting two pipeline stages.
+ * Popping from a closed and empty queue returns NULL.
+ */
+typedef struct Queue {
+    void **items;
+    int capacity;
+    int head;
+    int count;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} myqueue;
+
 enum Axis {
     V, H
 };
 
+/**
+ * How the links are stored.
+ * FULL keeps a whole row per point, so every pair is stored twice.
+ * UPPER keeps only the links to points with a greater id, so every pair is
+ * stored once, in the row of its smaller id.
+ * INDEX stores no links at all: two points are linked as long as they share
+ * a cell, and the pairs across a line are counted cell by cell from a
+ * range-count index of the points, see index_links().
+ */
+enum Storage {
+    FULL, UPPER, INDEX
+};
+
 enum File_Status{
     FILE_SUCCESS,
     FILE_NOT_EXISTS,
@@ -49,170 +652,5771 @@ enum File_Status{
 };
 
 /**
- * All initial points read from an input .txt file.
+ * The arena backing every array below; they are sized for the current
+ * instance and are only valid until restore().
+ * The state of the solver is per thread, so that restarts of an instance
+ * can be solved side by side.
+ */
+_Thread_local myarena arena;
+
+/**
+ * All initial points read from an input .txt file, stored as a struct of
+ * arrays indexed by point id, i.e. the position of the point in the file.
+ */
+_Thread_local int *pt_x;
+_Thread_local int *pt_y;
+
+/**
+ * The rank of every point by x- or y-coordinate, and the permutations from
+ * a rank back to a point id.
+ * Based on the project description, points in the input files are pre-sorted
+ * by the x-coordinates, so x_order and x_rank are the identity.
+ */
+_Thread_local int *x_rank;
+_Thread_local int *y_rank;
+_Thread_local int *x_order;
+_Thread_local int *y_order;
+
+/**
+ * The coordinates in rank order, so that finding the side of a line streams
+ * through one array.
+ */
+_Thread_local int *x_sorted;
+_Thread_local int *y_sorted;
+
+/**
+ * On the horizontal or vertical level, the lines needed at most to separate
+ * two adjacent points, i.e. every two adjacent points has a line right in the
+ * middle from the left to right or the bottom to top.
+ * Note: the lines are not final.
+ */
+_Thread_local myline *all_lines;
+_Thread_local myline **lines;
+
+/**
+ * The array of pointers to the finalized axis-parallel lines that optimally
+ * separate points.
+ */
+_Thread_local myline **final_lines;
+
+/**
+ * The masks of points at the two sides of a line, in the same layout as a row of links.
+ */
+_Thread_local myword *side_mask;
+_Thread_local myword *other_mask;
+
+/**
+ * The links of all points as one matrix.
+ * Word w of the row of point i is links[row_base[i] + w]; with UPPER storage
+ * only the words from row_first_word(i) on are stored.
+ */
+_Thread_local myword *links;
+_Thread_local int *row_base;
+int storage = FULL;
+
+/**
+ * With INDEX storage: the range-count index of the points, the ranks where
+ * the slabs of each axis start, ending with num_points, and the closest
+ * point of every candidate line, see line_splits().
+ */
+_Thread_local mywavelet wavelet;
+_Thread_local int *slab_starts[2];
+_Thread_local unsigned int num_slabs[2];
+_Thread_local int *line_split;
+
+_Thread_local unsigned int num_points = 0;
+/// the number of linked pairs of points, each pair counted once
+_Thread_local unsigned long long num_edges = 0;
+_Thread_local unsigned int num_lines = 0;
+_Thread_local unsigned int num_all_lines = 0;
+_Thread_local unsigned int num_words = 0;
+
+/**
+ * The input files to solve, in order.
+ */
+myjob *jobs = NULL;
+unsigned int num_jobs = 0;
+unsigned int jobs_capacity = 0;
+
+/**
+ * The directory of the rank-signature solution cache, or NULL if it is off,
+ * and the signature of the current instance.
+ */
+const char *cache_dir = NULL;
+_Thread_local uint32_t *signature;
+_Thread_local unsigned int signature_len = 0;
+_Thread_local uint64_t signature_hash = 0;
+unsigned int cache_hits = 0;
+unsigned int cache_misses = 0;
+
+/**
+ * The counting kernel picked at startup.
+ */
+const mykernel *kernel = NULL;
+
+/**
+ * Whether redundant lines are removed after solving, and how many were.
+ */
+int prune = 0;
+unsigned int num_pruned = 0;
+
+/**
+ * The wall-clock budget of solving one instance in milliseconds, 0 if there
+ * is none, and how the last instance fared: whether it ran out of time, how
+ * many lines the greedy had committed and how many pairs were still linked.
+ */
+long budget_ms = 0;
+_Thread_local struct timespec solve_start;
+_Thread_local int out_of_time = 0;
+_Thread_local unsigned int greedy_lines = 0;
+_Thread_local unsigned long long pairs_left = 0;
+unsigned int num_out_of_time = 0;
+
+/**
+ * The greedy stops after max_lines lines, or once target_fraction of the
+ * pairs are separated, if either is set; stopped_early tells whether the
+ * last instance was left with points sharing cells because of that.
+ */
+unsigned int max_lines = 0;
+double target_fraction = 0;
+_Thread_local int stopped_early = 0;
+
+/**
+ * Randomized restarts: how many to run per instance, the pool running them,
+ * their seed and how far below the best gain a randomized pick may be, as a
+ * fraction of it. randomized, rng_state and gains belong to the restart a
+ * thread is solving.
+ */
+int num_restarts = 1;
+mypool *restart_pool = NULL;
+int num_threads = 1;
+uint64_t restart_seed = 1;
+double near_max = 0;
+_Thread_local int randomized = 0;
+_Thread_local uint64_t rng_state = 0;
+_Thread_local long long *gains;
+
+/**
+ * Whether the greedy picks its lines from a tournament tree of gain bounds
+ * instead of evaluating every candidate on every step, see tree_best_line().
+ * gain_tree[t] is the index of the best candidate below node t, with the
+ * candidates at the leaves from gain_leaves on; gain_stamp[k] is the number
+ * of lines committed when the gain of candidate k was last evaluated.
+ */
+int select_tree = 1;
+_Thread_local int *gain_tree;
+_Thread_local unsigned int *gain_stamp;
+_Thread_local unsigned int gain_leaves = 0;
+
+/**
+ * Approximate gains: when approx_samples is set, the greedy estimates the
+ * gains of the candidates from that many points drawn at random on each
+ * step and may give up approx_error of the best gain to skip an exact
+ * evaluation, see approx_best_line(). approx_picks counts the lines of the
+ * last instance picked from estimates and approx_confirmed those picked on
+ * an exact gain. approx_drawn is the step the sample was drawn on,
+ * lower_bounds[k] the low end of the interval of the last estimate of
+ * candidate k and gain_exact[k] whether gains[k] is sure to bound its gain,
+ * being exact or the pairs across it before any line was committed. The
+ * points are drawn from the first num_live of live_points, which hold every
+ * point that may still be linked, approx_pool of them when the sample was
+ * drawn.
+ */
+unsigned int approx_samples = 0;
+double approx_error = 0.05;
+_Thread_local unsigned int approx_picks = 0;
+_Thread_local unsigned int approx_confirmed = 0;
+_Thread_local uint64_t approx_rng = 0;
+_Thread_local unsigned int approx_drawn = 0;
+_Thread_local int *approx_sample;
+_Thread_local unsigned int *approx_slab[2][2];
+_Thread_local double *approx_counts[2];
+_Thread_local int *live_points;
+_Thread_local unsigned int num_live = 0;
+_Thread_local unsigned int approx_pool = 0;
+_Thread_local double *lower_bounds;
+_Thread_local unsigned char *gain_exact;
+
+/**
+ * Whether instances are solved in two levels, on a grid of coarse_grid
+ * buckets per axis (0 for about 16 points per bucket) until no boundary
+ * separates coarse_cell^2 / 4 pairs, and whether the flat greedy is run too
+ * for comparison, see solve_coarse().
+ */
+int coarse = 0;
+unsigned int coarse_grid = 0;
+unsigned int coarse_cell = 1024;
+int coarse_compare = 0;
+
+/**
+ * Instances are solved by a beam search keeping beam_width states, each
+ * child scored by beam_depth - 1 greedy lines after its own, or by the
+ * greedy run until all points are separated if beam_depth is 0, if
+ * beam_width is set, see solve_beam().
+ */
+unsigned int beam_width = 0;
+unsigned int beam_depth = 0;
+
+/**
+ * Whether the restarts and the beam search report every instance they
+ * solve; the differential test solves too many to report.
+ */
+int report_solves = 1;
+
+/**
+ * Solutions are improved by local search for improve_ms milliseconds or
+ * improve_moves moves, whichever ends first, if either is set, see
+ * improve_solution().
+ */
+long improve_ms = 0;
+unsigned long long improve_moves = 0;
+
+/**
+ * Lines the greedy commits before picking any, such as lines already
+ * crossing the points from outside the instance, and the number of them
+ * that split the points, committed as the first final lines.
+ */
+_Thread_local const myline *preset_lines = NULL;
+_Thread_local unsigned int num_presets = 0;
+_Thread_local unsigned int presets_committed = 0;
+
+/**
+ * Instances of up to exact_max points are solved exactly, 0 if none are.
+ */
+unsigned int exact_max = 0;
+
+/**
+ * Whether every solution is reported with the gap to a lower bound, and
+ * the sum of the gaps.
+ */
+int report_bounds = 0;
+unsigned long total_gap = 0;
+unsigned int num_bounded = 0;
+
+/**
+ * The data of the reference greedy, kept apart from the solver's.
+ */
+myrefpoint ref_points[REF_MAX_POINTS];
+myrefpoint *ref_x_points[REF_MAX_POINTS];
+myrefpoint *ref_y_points[REF_MAX_POINTS];
+myline ref_all_lines[REF_MAX_POINTS * 2];
+myline *ref_lines[REF_MAX_POINTS * 2];
+myline *ref_final_lines[REF_MAX_POINTS * 2];
+unsigned int ref_num_points = 0;
+unsigned int ref_num_edges = 0;
+unsigned int ref_num_lines = 0;
+unsigned int ref_num_all_lines = 0;
+
+
+/**
+ * Counts the bits set in a word without relying on any instruction set extension.
+ */
+static unsigned int popcount_word(myword w) {
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (unsigned int)((w * 0x0101010101010101ULL) >> 56);
+}
+
+static int scalar_supported(void) {
+    return 1;
+}
+
+static unsigned int count_links_scalar(const myword *row, const myword *mask, unsigned int words) {
+    unsigned int num = 0;
+    unsigned int i = 0;
+    for (; i < words; i++) {
+        num += popcount_word(row[i] & mask[i]);
+    }
+    return num;
+}
+
+static unsigned int cut_links_scalar(myword *row, const myword *mask, unsigned int words) {
+    unsigned int num = 0;
+    unsigned int i = 0;
+    for (; i < words; i++) {
+        num += popcount_word(row[i] & mask[i]);
+        row[i] &= ~mask[i];
+    }
+    return num;
+}
+
+#ifdef HAVE_X86_KERNELS
+
+/**
+ * Reads the extended control register telling which register states the OS saves.
+ */
+static uint64_t xgetbv0(void) {
+    unsigned int lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static int sse42_supported(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    /// SSE4.2 is bit 20 and POPCNT is bit 23 of ECX.
+    return (ecx & (1u << 20)) && (ecx & (1u << 23));
+}
+
+static int avx2_supported(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!sse42_supported() || !__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    /// OSXSAVE is bit 27 and AVX is bit 28 of ECX; the OS must save XMM and YMM state.
+    if (!(ecx & (1u << 27)) || !(ecx & (1u << 28)) || (xgetbv0() & 0x6) != 0x6) {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (ebx & (1u << 5)) != 0;
+}
+
+static int avx512_supported(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!avx2_supported()) {
+        return 0;
+    }
+    /// The OS must also save the opmask and ZMM state.
+    if ((xgetbv0() & 0xe6) != 0xe6) {
+        return 0;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    /// AVX512F is bit 16 of EBX and AVX512_VPOPCNTDQ is bit 14 of ECX.
+    return (ebx & (1u << 16)) && (ecx & (1u << 14));
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static unsigned int count_links_sse42(const myword *row, const myword *mask, unsigned int words) {
+    unsigned int num = 0;
+    unsigned int i = 0;
+    for (; i < words; i++) {
+        num += (unsigned int)_mm_popcnt_u64(row[i] & mask[i]);
+    }
+    return num;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static unsigned int cut_links_sse42(myword *row, const myword *mask, unsigned int words) {
+    unsigned int num = 0;
+    unsigned int i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i r = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+        __m128i both = _mm_and_si128(r, m);
+        num += (unsigned int)_mm_popcnt_u64((uint64_t)_mm_cvtsi128_si64(both));
+        num += (unsigned int)_mm_popcnt_u64((uint64_t)_mm_extract_epi64(both, 1));
+        _mm_storeu_si128((__m128i *)(row + i), _mm_andnot_si128(m, r));
+    }
+    for (; i < words; i++) {
+        num += (unsigned int)_mm_popcnt_u64(row[i] & mask[i]);
+        row[i] &= ~mask[i];
+    }
+    return num;
+}
+
+/**
+ * Counts the bits of a 256-bit vector per 64-bit lane by looking up each nibble.
+ */
+__attribute__((target("avx2")))
+static inline __m256i popcount_avx2(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static inline unsigned int sum_lanes_avx2(__m256i acc) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return (unsigned int)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+__attribute__((target("avx2,popcnt")))
+static unsigned int count_links_avx2(const myword *row, const myword *mask, unsigned int words) {
+    __m256i acc = _mm256_setzero_si256();
+    unsigned int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mask + i));
+        acc = _mm256_add_epi64(acc, popcount_avx2(_mm256_and_si256(r, m)));
+    }
+    unsigned int num = sum_lanes_avx2(acc);
+    for (; i < words; i++) {
+        num += (unsigned int)_mm_popcnt_u64(row[i] & mask[i]);
+    }
+    return num;
+}
+
+__attribute__((target("avx2,popcnt")))
+static unsigned int cut_links_avx2(myword *row, const myword *mask, unsigned int words) {
+    __m256i acc = _mm256_setzero_si256();
+    unsigned int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i r = _mm256_loadu_si256((const __m256i *)(row + i));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mask + i));
+        acc = _mm256_add_epi64(acc, popcount_avx2(_mm256_and_si256(r, m)));
+        _mm256_storeu_si256((__m256i *)(row + i), _mm256_andnot_si256(m, r));
+    }
+    unsigned int num = sum_lanes_avx2(acc);
+    for (; i < words; i++) {
+        num += (unsigned int)_mm_popcnt_u64(row[i] & mask[i]);
+        row[i] &= ~mask[i];
+    }
+    return num;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static unsigned int count_links_avx512(const myword *row, const myword *mask, unsigned int words) {
+    __m512i acc = _mm512_setzero_si512();
+    unsigned int i = 0;
+    for (; i + 8 <= words; i += 8) {
+        __m512i r = _mm512_loadu_si512((const void *)(row + i));
+        __m512i m = _mm512_loadu_si512((const void *)(mask + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(r, m)));
+    }
+    if (i < words) {
+        /// the tail is loaded under a lane mask instead of a scalar loop
+        __mmask8 tail = (__mmask8)((1u << (words - i)) - 1);
+        __m512i r = _mm512_maskz_loadu_epi64(tail, (const void *)(row + i));
+        __m512i m = _mm512_maskz_loadu_epi64(tail, (const void *)(mask + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(r, m)));
+    }
+    return (unsigned int)_mm512_reduce_add_epi64(acc);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static unsigned int cut_links_avx512(myword *row, const myword *mask, unsigned int words) {
+    __m512i acc = _mm512_setzero_si512();
+    unsigned int i = 0;
+    for (; i + 8 <= words; i += 8) {
+        __m512i r = _mm512_loadu_si512((const void *)(row + i));
+        __m512i m = _mm512_loadu_si512((const void *)(mask + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(r, m)));
+        _mm512_storeu_si512((void *)(row + i), _mm512_andnot_si512(m, r));
+    }
+    if (i < words) {
+        __mmask8 tail = (__mmask8)((1u << (words - i)) - 1);
+        __m512i r = _mm512_maskz_loadu_epi64(tail, (const void *)(row + i));
+        __m512i m = _mm512_maskz_loadu_epi64(tail, (const void *)(mask + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_and_si512(r, m)));
+        _mm512_mask_storeu_epi64((void *)(row + i), tail, _mm512_andnot_si512(m, r));
+    }
+    return (unsigned int)_mm512_reduce_add_epi64(acc);
+}
+
+#endif
+
+/**
+ * All counting kernels, from the fastest to the portable fallback.
+ */
+const mykernel kernels[] = {
+#ifdef HAVE_X86_KERNELS
+    {"avx512", avx512_supported, count_links_avx512, cut_links_avx512},
+    {"avx2", avx2_supported, count_links_avx2, cut_links_avx2},
+    {"sse42", sse42_supported, count_links_sse42, cut_links_sse42},
+#endif
+    {"scalar", scalar_supported, count_links_scalar, cut_links_scalar}
+};
+#define NUM_KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+/**
+ * Functions taking the axis as a constant argument are always inlined into
+ * their per-axis wrappers, so each wrapper is compiled for one axis with the
+ * axis branches folded away.
+ */
+#if defined(__GNUC__)
+#define AXIS_SPECIALIZED static inline __attribute__((always_inline))
+#else
+#define AXIS_SPECIALIZED static inline
+#endif
+
+/**
+ * Picks the counting kernel: the named one if a name is given, otherwise the
+ * fastest one the CPU supports.
+ * @param name - a kernel name, or NULL
+ * @return - the kernel, or NULL if the name is unknown or not supported
+ */
+const mykernel *select_kernel(const char *name) {
+    int i = 0;
+    for (; i < NUM_KERNELS; i++) {
+        if (name != NULL && strcmp(name, kernels[i].name) != 0) {
+            continue;
+        }
+        if (kernels[i].supported()) {
+            return &(kernels[i]);
+        }
+        if (name != NULL) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * Returns a block of memory aligned to ARENA_ALIGN, counting the malloc
+ * calls made to get it.
+ * @param raw - receives the pointer to pass to free()
+ */
+static char *aligned_block(size_t size, char **raw) {
+    *raw = malloc(size + ARENA_ALIGN);
+    if (*raw == NULL) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    arena.num_mallocs++;
+    return *raw + (ARENA_ALIGN - (uintptr_t)*raw % ARENA_ALIGN) % ARENA_ALIGN;
+}
+
+/**
+ * Allocates memory for the current instance from the arena.
+ * The memory is not cleared.
+ * @param size - the number of bytes
+ */
+void *arena_alloc(size_t size) {
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    arena.peak += size;
+    if (arena.used + size <= arena.size) {
+        void *p = arena.base + arena.used;
+        arena.used += size;
+        return p;
+    }
+
+    /// the arena is too small for this instance; this block lives until the next reset
+    char *raw;
+    char *data = aligned_block(sizeof (myblock) + ARENA_ALIGN + size, &raw);
+    ((myblock *)raw)->next = arena.overflow;
+    arena.overflow = (myblock *)raw;
+    return data + ARENA_ALIGN;
+}
+
+/**
+ * Releases all memory of the current instance at once.
+ * If the instance overflowed the arena, the arena is regrown to its high-water mark.
+ */
+void arena_reset() {
+    if (arena.overflow != NULL) {
+        while (arena.overflow != NULL) {
+            myblock *next = arena.overflow->next;
+            free(arena.overflow);
+            arena.overflow = next;
+        }
+        free(arena.raw);
+        arena.base = aligned_block(arena.peak, &arena.raw);
+        arena.size = arena.peak;
+    }
+    arena.used = 0;
+    arena.peak = 0;
+}
+
+/**
+ * Releases the arena of the calling thread for good.
+ */
+void arena_free() {
+    arena_reset();
+    free(arena.raw);
+    arena.raw = NULL;
+    arena.base = NULL;
+    arena.size = 0;
+}
+
+void *grow_array(void *p, size_t size) {
+    p = realloc(p, size);
+    if (p == NULL) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+/**
+ * Allocates the point arrays of an instance of num_points points.
+ */
+void alloc_points() {
+    pt_x = arena_alloc(sizeof (int) * num_points);
+    pt_y = arena_alloc(sizeof (int) * num_points);
+    x_rank = arena_alloc(sizeof (int) * num_points);
+    y_rank = arena_alloc(sizeof (int) * num_points);
+    x_order = arena_alloc(sizeof (int) * num_points);
+    y_order = arena_alloc(sizeof (int) * num_points);
+    x_sorted = arena_alloc(sizeof (int) * num_points);
+    y_sorted = arena_alloc(sizeof (int) * num_points);
+}
+
+/**
+ * Empties a cell set and sizes it for n points, at most half full; n must
+ * not exceed the number of points it was created for.
+ */
+void cellset_clear(mycellset *s, unsigned int n) {
+    size_t slots = 16;
+    while (slots < 2 * (size_t)n) {
+        slots <<= 1;
+    }
+    s->mask = slots - 1;
+    memset(s->keys, 0, sizeof (uint64_t) * slots);
+}
+
+/**
+ * Creates an empty cell set for n points. Its memory comes from the arena.
+ */
+void cellset_init(mycellset *s, unsigned int n) {
+    size_t slots = 16;
+    while (slots < 2 * (size_t)n) {
+        slots <<= 1;
+    }
+    s->keys = arena_alloc(sizeof (uint64_t) * slots);
+    s->ids = arena_alloc(sizeof (int) * slots);
+    cellset_clear(s, n);
+}
+
+/**
+ * Puts a point into its cell, unless another point is there already.
+ * @param key - the cell, from cell_key()
+ * @param id - the point id
+ * @return the id of the point already in the cell, or -1 if it was empty
+ */
+static inline int cellset_insert(mycellset *s, uint64_t key, int id) {
+    size_t slot = cell_hash(key) & s->mask;
+    while (s->keys[slot] != 0) {
+        if (s->keys[slot] == key + 1) {
+            return s->ids[slot];
+        }
+        slot = (slot + 1) & s->mask;
+    }
+    s->keys[slot] = key + 1;
+    s->ids[slot] = id;
+    return -1;
+}
+
+/**
+ * Finds the point in a cell.
+ * @return its id, or -1 if the cell is empty
+ */
+static inline int cellset_find(const mycellset *s, uint64_t key) {
+    size_t slot = cell_hash(key) & s->mask;
+    while (s->keys[slot] != 0) {
+        if (s->keys[slot] == key + 1) {
+            return s->ids[slot];
+        }
+        slot = (slot + 1) & s->mask;
+    }
+    return -1;
+}
+
+/**
+ * Takes the point out of a cell. The entries after it that probed past its
+ * slot are shifted back, so that lookups need no tombstones.
+ */
+void cellset_remove(mycellset *s, uint64_t key) {
+    size_t slot = cell_hash(key) & s->mask;
+    while (s->keys[slot] != key + 1) {
+        if (s->keys[slot] == 0) {
+            return;
+        }
+        slot = (slot + 1) & s->mask;
+    }
+    size_t hole = slot;
+    for (;;) {
+        slot = (slot + 1) & s->mask;
+        if (s->keys[slot] == 0) {
+            break;
+        }
+        /// an entry may fill the hole unless its home slot lies after the hole
+        size_t home = cell_hash(s->keys[slot] - 1) & s->mask;
+        if (((slot - home) & s->mask) >= ((slot - hole) & s->mask)) {
+            s->keys[hole] = s->keys[slot];
+            s->ids[hole] = s->ids[slot];
+            hole = slot;
+        }
+    }
+    s->keys[hole] = 0;
+}
+
+/**
+ * Returns the slab of a coordinate among the sorted coordinates of the lines
+ * of one axis, i.e. the number of lines it lies to the right of or above.
+ * As in the solver, a point on a line is on its left or bottom side, but
+ * coordinates are compared exactly, as written in the files.
+ * The search is branchless, as it runs once per point and axis.
+ */
+static inline unsigned int slab_index(const double *coords, unsigned int count, int c) {
+    const double f = c;
+    const double *base = coords;
+    unsigned int len = count;
+    if (len == 0) {
+        return 0;
+    }
+    while (len > 1) {
+        unsigned int half = len / 2;
+        base = base[half - 1] < f ? base + half : base;
+        len -= half;
+    }
+    return (unsigned int)(base - coords) + (*base < f);
+}
+
+/**
+ * Reads a whole file into a text buffer, terminated by a NUL character.
+ * @return 1 on success, 0 if the file cannot be opened
+ */
+int load_text(mytext *t, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+    t->size = 0;
+    t->pos = 0;
+    for (;;) {
+        if (t->capacity - t->size < TEXT_CHUNK + 1) {
+            t->capacity = t->capacity * 2 > t->size + TEXT_CHUNK + 1 ? t->capacity * 2 : t->size + TEXT_CHUNK + 1;
+            t->data = realloc(t->data, t->capacity);
+            if (t->data == NULL) {
+                printf("Out of memory\n");
+                exit(1);
+            }
+        }
+        size_t got = fread(t->data + t->size, 1, t->capacity - t->size - 1, file);
+        if (got == 0) {
+            break;
+        }
+        t->size += got;
+    }
+    fclose(file);
+    t->data[t->size] = '\0';
+    return 1;
+}
+
+/**
+ * Parses the next decimal integer of a text, skipping white space before it.
+ * @param value - receives the integer
+ * @return 1 on success, 0 at the end of the text, on anything but a number,
+ * or on a number out of the range of int
+ */
+static inline int next_int(mytext *t, int *value) {
+    const char *p = t->data + t->pos;
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return 0;
+    }
+    long long v = 0;
+    while (*p >= '0' && *p <= '9') {
+        if (v <= INT_MAX) {
+            v = v * 10 + (*p - '0');
+        }
+        p++;
+    }
+    if (v > (long long)INT_MAX + negative) {
+        return 0;
+    }
+    *value = (int)(negative ? -v : v);
+    t->pos = p - t->data;
+    return 1;
+}
+
+/**
+ * Parses the next line of a solution text, "v 1.5" or "h 2.0".
+ * The coordinate is kept as a double, exactly as written.
+ * @param axis - receives the axis of the line
+ * @param coord - receives the coordinate of the line
+ * @return 1 on success, 0 at the end of the text or on anything else
+ */
+int next_line(mytext *t, int *axis, double *coord) {
+    const char *p = t->data + t->pos;
+    while (isspace((unsigned char)*p)) {
+        p++;
+    }
+    if (*p != 'v' && *p != 'h') {
+        return 0;
+    }
+    char *end;
+    *axis = *p == 'v' ? V : H;
+    *coord = strtod(p + 1, &end);
+    if (end == p + 1) {
+        return 0;
+    }
+    t->pos = end - t->data;
+    return 1;
+}
+
+/**
+ * Tells whether only white space is left in a text.
+ */
+int text_end(mytext *t) {
+    while (isspace((unsigned char)t->data[t->pos])) {
+        t->pos++;
+    }
+    return t->pos == t->size;
+}
+
+void free_instance(myinstance *inst) {
+    free(inst->x);
+    free(inst->y);
+    free(inst->text.data);
+}
+
+/**
+ * Reads an input .txt file and stores points' information.
+ * @param job - the input file
+ * @param inst - the instance to read into
+ * @return - a file status
+ */
+int read_file(const myjob *job, myinstance *inst) {
+    inst->job = job;
+    inst->num_points = 0;
+
+    if(!load_text(&inst->text, job->input)){
+        return inst->status = FILE_NOT_EXISTS;
+    }
+
+    int count = 0;
+    if(!next_int(&inst->text, &count) || count <= 0){
+        return inst->status = FILE_NO_POINTS;
+    }
+    unsigned int n = (unsigned int)count;
+    if(n > inst->capacity){
+        inst->x = realloc(inst->x, sizeof (int) * n);
+        inst->y = realloc(inst->y, sizeof (int) * n);
+        if(inst->x == NULL || inst->y == NULL){
+            printf("Out of memory\n");
+            exit(1);
+        }
+        inst->capacity = n;
+    }
+
+    /// Values scanned from the input file and stored as points' information
+    unsigned int i = 0;
+    int x = 0;
+    int y = 0;
+    while(next_int(&inst->text, &x) && next_int(&inst->text, &y)){
+        if(i < n){
+            inst->x[i] = x;
+            inst->y[i] = y;
+        }
+        i++;
+    }
+
+    if(i != n){
+        return inst->status = FILE_ERROR_POINTS;
+    }
+    inst->num_points = n;
+    return inst->status = FILE_SUCCESS;
+}
+
+/**
+ * Loads points into the solver.
+ * @param n - the number of points
+ * @param x - the x-coordinates, in file order
+ * @param y - the y-coordinates, in file order
+ */
+void load_points(unsigned int n, const int *x, const int *y) {
+    unsigned int i = 0;
+    num_points = n;
+    alloc_points();
+    memcpy(pt_x, x, sizeof (int) * num_points);
+    memcpy(pt_y, y, sizeof (int) * num_points);
+    for (; i < num_points; i++) {
+        x_order[i] = i;
+        y_order[i] = i;
+    }
+}
+
+/**
+ * Loads a successfully read instance into the solver.
+ * @param inst - the instance
+ */
+void load_instance(const myinstance *inst) {
+    load_points(inst->num_points, inst->x, inst->y);
+}
+
+/**
+ * Copies the committed lines out of the solver.
+ * @param job - the input file of the instance, or NULL if it has none
+ * @param sol - the solution to fill in
+ */
+void store_solution(const myjob *job, mysolution *sol) {
+    unsigned int i = 0;
+    if (num_lines > sol->capacity) {
+        sol->lines = realloc(sol->lines, sizeof (myline) * num_lines);
+        if (sol->lines == NULL) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        sol->capacity = num_lines;
+    }
+    sol->job = job;
+    sol->num_lines = num_lines;
+    for (; i < num_lines; i++) {
+        sol->lines[i] = *final_lines[i];
+    }
+}
+
+/**
+ * Writes the results into an output .txt file
+ * @param sol - the solution, written to the output file of its job
+ */
+void write_file(const mysolution *sol){
+    FILE *output = fopen(sol->job->output, "w");
+    if(output == NULL){
+        printf("Cannot write %s\n", sol->job->output);
+        return;
+    }
+    fprintf(output, "%d\n", sol->num_lines);
+
+    int i = 0;
+    for(; i < sol->num_lines; i++){
+        if(sol->lines[i].axis == V) {
+            fprintf(output, "v ");
+        } else {
+            fprintf(output, "h ");
+        }
+        fprintf(output, "%.1f\n", sol->lines[i].coord);
+    }
+    fclose(output);
+}
+
+
+const char *storage_name(int s) {
+    return s == INDEX ? "index" : s == UPPER ? "upper" : "full";
+}
+
+/**
+ * Returns the first word stored in the row of links of a point.
+ * @param id - the point id
+ */
+static inline unsigned int row_first_word(int id) {
+    return storage == UPPER ? (id + 1) / WORD_BITS : 0;
+}
+
+/**
+ * Returns the milliseconds elapsed since a start time.
+ */
+long elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000L + (now.tv_nsec - start->tv_nsec) / 1000000L;
+}
+
+/**
+ * Tells whether the budget of the instance being solved is spent, and if it
+ * is sets out_of_time, which stays set until the next instance.
+ */
+int budget_spent() {
+    if (budget_ms > 0 && !out_of_time && elapsed_ms(&solve_start) >= budget_ms) {
+        out_of_time = 1;
+    }
+    return out_of_time;
+}
+
+/**
+ * Links all points. If the budget is spent first the rows left stay
+ * unlinked, and num_edges still counts every pair as nothing is separated.
+ */
+void link_points() {
+    int i = 0;
+    int j = 0;
+    int size = 0;
+    num_words = (num_points + WORD_BITS - 1) / WORD_BITS;
+    side_mask = arena_alloc(sizeof (myword) * num_words);
+    other_mask = arena_alloc(sizeof (myword) * num_words);
+    row_base = arena_alloc(sizeof (int) * num_points);
+    for (i = 0; i < num_points; i++) {
+        row_base[i] = size - row_first_word(i);
+        size += num_words - row_first_word(i);
+    }
+    links = arena_alloc(sizeof (myword) * size);
+    memset(links, 0, sizeof (myword) * size);
+    for (i = 0; i < num_points; i++) {
+        myword *row = links + row_base[i];
+        if (i % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            num_edges = (unsigned long long)num_points * (num_points - 1) / 2;
+            return;
+        }
+        for (j = storage == UPPER ? i + 1 : 0; j < num_points; j++) {
+            if (i != j) {
+                row[j / WORD_BITS] |= (myword)1 << (j % WORD_BITS);
+            }
+            if (j > i) {
+                num_edges++;
+            }
+        }
+    }
+
+    if (num_edges != (unsigned long long)num_points * (num_points - 1) / 2) {
+        printf("The number of points is incorrect");
+        exit(0);
+    }
+}
+
+/**
+ * Sets the mask to the points of rank from to rank to - 1.
+ * On the vertical axis the ranks are the point ids, so the mask is one run of
+ * bits and only the words [*lo, *hi) of it can be non-zero.
+ * On the horizontal axis the ids are scattered through y_order and the whole
+ * mask is used.
+ */
+AXIS_SPECIALIZED void build_side_mask(const int axis, myword *mask, int from, int to,
+                                      unsigned int *lo, unsigned int *hi) {
+    if (axis == V) {
+        *lo = from / WORD_BITS;
+        *hi = (to + WORD_BITS - 1) / WORD_BITS;
+        unsigned int w = *lo;
+        for (; w < *hi; w++) {
+            mask[w] = ~(myword)0;
+        }
+        mask[*lo] &= ~(myword)0 << (from % WORD_BITS);
+        if (to % WORD_BITS != 0) {
+            mask[*hi - 1] &= ~(~(myword)0 << (to % WORD_BITS));
+        }
+    } else {
+        *lo = 0;
+        *hi = num_words;
+        memset(mask, 0, sizeof (myword) * num_words);
+        for (; from < to; from++) {
+            mask[y_order[from] / WORD_BITS] |= (myword)1 << (y_order[from] % WORD_BITS);
+        }
+    }
+}
+
+/**
+ * Releases the memory of the instance.
+ * Re-initializes the number of points, lines, edges and all_lines.
+ */
+void restore() {
+    arena_reset();
+    num_points = 0;
+    num_lines = 0;
+    num_edges = 0;
+    num_all_lines = 0;
+}
+
+
+/**
+ * Returns the index of the point closest to the left or bottom of a line,
+ * which takes at most O(n) time.
+ * If there is no point to the left or bottom of the line, return -1.
+ * @param ln - pointer to a line struct
+ * @param axis - the axis of the line
+ */
+AXIS_SPECIALIZED int closest_point_axis(const myline *ln, const int axis) {
+    const int *sorted = axis == V ? x_sorted : y_sorted;
+    const float coord = ln->coord;
+    int i = 0;
+    for (; i < num_points; i++) {
+        if ((float)sorted[i] > coord) {
+            return i - 1;
+        }
+    }
+    return -1;
+}
+
+int closest_point_v(myline *ln) {
+    return closest_point_axis(ln, V);
+}
+
+int closest_point_h(myline *ln) {
+    return closest_point_axis(ln, H);
+}
+
+int closest_point(myline *ln) {
+    return ln->axis == V ? closest_point_v(ln) : closest_point_h(ln);
+}
+
+/**
+ * Pre-separate points by using axis-parallel lines, which are not final.
+ * From left to right, every two adjacent points are separated by a line whose x-coordinate
+ * equals to the average of their x-coordinates.
+ * From bottom to top, same lines are created.
+ */
+void pre_separate() {
+    int i = 0;
+    myline *v_ln;
+    myline *h_ln;
+    all_lines = arena_alloc(sizeof (myline) * 2 * num_points);
+    lines = arena_alloc(sizeof (myline *) * 2 * num_points);
+    final_lines = arena_alloc(sizeof (myline *) * 2 * num_points);
+    for (; i < num_points - 1; i++) {
+        v_ln = &(all_lines[num_all_lines]);
+        v_ln->axis = V;
+        v_ln->coord = ((float)x_sorted[i] + (float)x_sorted[i + 1]) / 2;
+        lines[num_all_lines] = v_ln;
+        num_all_lines++;
+
+    }
+    for (i = 0; i < num_points - 1; i++) {
+        h_ln = &(all_lines[num_all_lines]);
+        h_ln->axis = H;
+        h_ln->coord = ((float)y_sorted[i] + (float)y_sorted[i + 1]) / 2;
+        lines[num_all_lines] = h_ln;
+        num_all_lines++;
+    }
+}
+
+/**
+ * Finds closest_point() of every candidate line in O(n) overall, using that
+ * the candidates of each axis are sorted by coordinate.
+ * @param split - receives the closest point of all_lines[k] at index k
+ */
+void line_splits(int *split) {
+    unsigned int k = 0;
+    for (; k < num_all_lines; k++) {
+        const int *sorted = all_lines[k].axis == V ? x_sorted : y_sorted;
+        unsigned int first = all_lines[k].axis == V ? 0 : num_points - 1;
+        /// the first point beyond the line, searched from where the previous line's search ended
+        unsigned int i = k == first ? 0 : (split[k - 1] < 0 ? num_points : split[k - 1] + 1);
+        while (i < num_points && (float)sorted[i] <= all_lines[k].coord) {
+            i++;
+        }
+        split[k] = i < num_points ? (int)i - 1 : -1;
+    }
+}
+
+
+/**
+ * Builds the wavelet matrix of the points and the first slab of each axis,
+ * in O(n log n), for INDEX storage; every pair of points starts out linked.
+ */
+void index_points() {
+    int *values = arena_alloc(sizeof (int) * num_points);
+    int *next = arena_alloc(sizeof (int) * num_points);
+    mywavelet *w = &wavelet;
+    unsigned int i = 0;
+    unsigned int l = 0;
+    int a = 0;
+
+    w->n = num_points;
+    w->levels = 1;
+    while ((1u << w->levels) < num_points) {
+        w->levels++;
+    }
+    w->words = (num_points + WORD_BITS - 1) / WORD_BITS;
+    w->bits = arena_alloc(sizeof (myword) * w->levels * w->words);
+    w->ones = arena_alloc(sizeof (unsigned int) * w->levels * (w->words + 1));
+    w->zeros = arena_alloc(sizeof (unsigned int) * w->levels);
+    memset(w->bits, 0, sizeof (myword) * w->levels * w->words);
+    for (; i < num_points; i++) {
+        values[i] = y_rank[x_order[i]];
+    }
+    for (; l < w->levels; l++) {
+        myword *bits = w->bits + l * w->words;
+        unsigned int *ones = w->ones + l * (w->words + 1);
+        unsigned int shift = w->levels - 1 - l;
+        unsigned int num_zeros = 0;
+        unsigned int k = 0;
+        for (i = 0; i < num_points; i++) {
+            unsigned int bit = ((unsigned int)values[i] >> shift) & 1;
+            bits[i / WORD_BITS] |= (myword)bit << (i % WORD_BITS);
+            num_zeros += !bit;
+        }
+        ones[0] = 0;
+        for (k = 0; k < w->words; k++) {
+            ones[k + 1] = ones[k] + popcount_word(bits[k]);
+        }
+        w->zeros[l] = num_zeros;
+        /// stable partition by the bit: zeros first, then ones
+        unsigned int z = 0;
+        unsigned int o = num_zeros;
+        for (i = 0; i < num_points; i++) {
+            if ((((unsigned int)values[i] >> shift) & 1) == 0) {
+                next[z++] = values[i];
+            } else {
+                next[o++] = values[i];
+            }
+        }
+        int *swap = values;
+        values = next;
+        next = swap;
+    }
+
+    for (a = 0; a < 2; a++) {
+        slab_starts[a] = arena_alloc(sizeof (int) * (num_points + 1));
+        slab_starts[a][0] = 0;
+        slab_starts[a][1] = (int)num_points;
+        num_slabs[a] = 1;
+    }
+    line_split = arena_alloc(sizeof (int) * num_all_lines);
+    line_splits(line_split);
+    num_edges = (unsigned long long)num_points * (num_points - 1) / 2;
+}
+
+
+/**
+ * Returns the row of links of the point of the given rank.
+ */
+AXIS_SPECIALIZED myword *rank_links(const int axis, int rank) {
+    return links + row_base[axis == V ? rank : y_order[rank]];
+}
+
+/**
+ * Counts, or counts and breaks, a row of links against a mask.
+ */
+AXIS_SPECIALIZED unsigned int visit_links(myword *row, const myword *mask, unsigned int words, const int cut) {
+    return cut ? kernel->cut_links(row, mask, words) : kernel->count_links(row, mask, words);
+}
+
+/**
+ * Counts, or counts and breaks, the links across a line with FULL storage.
+ * Counting walks the rows of the smaller side against a mask of the other
+ * side; breaking has to clear both rows of every pair.
+ * @param closest - the rank of the point closest to the left or bottom of the line
+ * @return the number of pairs linked across the line
+ */
+AXIS_SPECIALIZED unsigned int full_links(const int axis, int closest, const int cut) {
+    unsigned int num_links = 0;
+    unsigned int lo, hi;
+    int i;
+    if (cut || closest + 1 <= (int)num_points - closest - 1) {
+        build_side_mask(axis, side_mask, closest + 1, num_points, &lo, &hi);
+        for (i = 0; i <= closest; i++) {
+            num_links += visit_links(rank_links(axis, i) + lo, side_mask + lo, hi - lo, cut);
+        }
+    }
+    if (cut || closest + 1 > (int)num_points - closest - 1) {
+        unsigned int num = 0;
+        build_side_mask(axis, side_mask, 0, closest + 1, &lo, &hi);
+        for (i = closest + 1; i < num_points; i++) {
+            num += visit_links(rank_links(axis, i) + lo, side_mask + lo, hi - lo, cut);
+        }
+        if (!cut) {
+            num_links = num;
+        }
+    }
+    return num_links;
+}
+
+/**
+ * Counts, or counts and breaks, the links across a line with UPPER storage.
+ * A pair is stored in the row of its smaller id only. Across a vertical line
+ * that is always the left point, so only the left rows are visited; across a
+ * horizontal line every row is visited against the mask of the other side.
+ * @param closest - the rank of the point closest to the left or bottom of the line
+ * @return the number of pairs linked across the line
+ */
+AXIS_SPECIALIZED unsigned int upper_links(const int axis, int closest, const int cut) {
+    unsigned int num_links = 0;
+    unsigned int lo, hi;
+    int i;
+    build_side_mask(axis, side_mask, closest + 1, num_points, &lo, &hi);
+    if (axis == V) {
+        for (i = 0; i <= closest; i++) {
+            num_links += visit_links(links + row_base[i] + lo, side_mask + lo, hi - lo, cut);
+        }
+        return num_links;
+    }
+    build_side_mask(axis, other_mask, 0, closest + 1, &lo, &hi);
+    for (i = 0; i < num_points; i++) {
+        int id = y_order[i];
+        unsigned int first = row_first_word(id);
+        const myword *mask = i <= closest ? side_mask : other_mask;
+        num_links += visit_links(links + row_base[id] + first, mask + first, num_words - first, cut);
+    }
+    return num_links;
+}
+
+/**
+ * Returns the number of the first i positions of a wavelet level holding a one.
+ */
+static inline unsigned int wavelet_ones(const mywavelet *w, unsigned int l, unsigned int i) {
+    const myword *bits = w->bits + l * w->words;
+    unsigned int r = w->ones[l * (w->words + 1) + i / WORD_BITS];
+    if (i % WORD_BITS != 0) {
+        r += popcount_word(bits[i / WORD_BITS] & ~(~(myword)0 << (i % WORD_BITS)));
+    }
+    return r;
+}
+
+/**
+ * Counts the points of x-rank in [from, to) with a y-rank below c, in O(log n).
+ */
+static inline unsigned int wavelet_below(const mywavelet *w, unsigned int from, unsigned int to, unsigned int c) {
+    unsigned int count = 0;
+    unsigned int l = 0;
+    if (c >= (1u << w->levels)) {
+        return to - from;
+    }
+    for (; l < w->levels && from < to; l++) {
+        unsigned int from_ones = wavelet_ones(w, l, from);
+        unsigned int to_ones = wavelet_ones(w, l, to);
+        if ((c >> (w->levels - 1 - l)) & 1) {
+            count += (to - to_ones) - (from - from_ones);
+            from = w->zeros[l] + from_ones;
+            to = w->zeros[l] + to_ones;
+        } else {
+            from -= from_ones;
+            to -= to_ones;
+        }
+    }
+    return count;
+}
+
+/**
+ * Counts the points of x-rank in [x_from, x_to) and y-rank in [y_from, y_to).
+ */
+static inline unsigned long long range_count(unsigned int x_from, unsigned int x_to,
+                                             unsigned int y_from, unsigned int y_to) {
+    return wavelet_below(&wavelet, x_from, x_to, y_to) - wavelet_below(&wavelet, x_from, x_to, y_from);
+}
+
+/**
+ * Counts, or counts and commits, the pairs across a line with INDEX storage.
+ * Two points are linked as long as they share a cell, so the line breaks,
+ * in every cell of the slab it cuts, the points on its one side times the
+ * points on its other side, each counted in O(log n): O(m log n) in all
+ * for m slabs of the other axis. Committing only records the new slab.
+ * @param closest - the rank of the point closest to the left or bottom of the line
+ * @return the number of pairs linked across the line
+ */
+AXIS_SPECIALIZED unsigned long long index_links(const int axis, int closest, const int cut) {
+    const int *starts = slab_starts[axis];
+    const int *other = slab_starts[1 - axis];
+    unsigned long long num_links = 0;
+    unsigned int lo = 0;
+    unsigned int hi = num_slabs[axis];
+    unsigned int k = 0;
+    /// the slab holding closest is the last one starting at or before it
+    while (hi - lo > 1) {
+        unsigned int mid = (lo + hi) / 2;
+        if (starts[mid] <= closest) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    unsigned int from = (unsigned int)starts[lo];
+    unsigned int split = (unsigned int)closest + 1;
+    unsigned int to = (unsigned int)starts[lo + 1];
+    if (split == to) {
+        return 0;
+    }
+    for (; k < num_slabs[1 - axis]; k++) {
+        unsigned int other_from = (unsigned int)other[k];
+        unsigned int other_to = (unsigned int)other[k + 1];
+        if (axis == V) {
+            num_links += range_count(from, split, other_from, other_to)
+                         * range_count(split, to, other_from, other_to);
+        } else {
+            num_links += range_count(other_from, other_to, from, split)
+                         * range_count(other_from, other_to, split, to);
+        }
+    }
+    if (cut) {
+        int *slabs = slab_starts[axis];
+        memmove(&slabs[lo + 2], &slabs[lo + 1], sizeof (int) * (num_slabs[axis] - lo));
+        slabs[lo + 1] = (int)split;
+        num_slabs[axis]++;
+    }
+    return num_links;
+}
+
+/**
+ * Returns the number of links that a line can break, which takes O(n^2)
+ * with link storage and O(m log n) with INDEX storage.
+ * Returns -1 if no link can be broken.
+ * @param ln - pointer to a line struct
+ * @param axis - the axis of the line
+ * @return the number of links that a line can break.
+ */
+AXIS_SPECIALIZED long long links_to_break_axis(myline *ln, const int axis) {
+    /// computes the number of links of points on different sides of the line.
+    int closest = storage == INDEX ? line_split[ln - all_lines] : closest_point_axis(ln, axis);
+    if (closest < 0) {
+        return 0;
+    }
+    if (storage == INDEX) {
+        return (long long)index_links(axis, closest, 0);
+    }
+    if (storage == UPPER) {
+        return upper_links(axis, closest, 0);
+    }
+    return full_links(axis, closest, 0);
+}
+
+long long links_to_break_v(myline *ln) {
+    return links_to_break_axis(ln, V);
+}
+
+long long links_to_break_h(myline *ln) {
+    return links_to_break_axis(ln, H);
+}
+
+long long links_to_break(myline *ln) {
+    if (ln == NULL) {
+        return 0;
+    }
+    return ln->axis == V ? links_to_break_v(ln) : links_to_break_h(ln);
+}
+
+/**
+ * Finalizes the axis-parallel lines that optimally separates points.
+ * @param ln - pointer to a line struct
+ * @param axis - the axis of the line
+ */
+AXIS_SPECIALIZED void finalize_lines_axis(myline *ln, const int axis) {
+    final_lines[num_lines] = ln;
+    int closest = storage == INDEX ? line_split[ln - all_lines] : closest_point_axis(ln, axis);
+
+    /// unlinks points at the two sides of the line to be committed
+    if (closest >= 0) {
+        if (storage == INDEX) {
+            num_edges -= index_links(axis, closest, 1);
+        } else if (storage == UPPER) {
+            num_edges -= upper_links(axis, closest, 1);
+        } else {
+            num_edges -= full_links(axis, closest, 1);
+        }
+    }
+    num_lines++;
+}
+
+void finalize_lines_v(myline *ln) {
+    finalize_lines_axis(ln, V);
+}
+
+void finalize_lines_h(myline *ln) {
+    finalize_lines_axis(ln, H);
+}
+
+void finalize_lines(myline *ln) {
+    if (ln == NULL) {
+        return;
+    }
+    if (ln->axis == V) {
+        finalize_lines_v(ln);
+    } else {
+        finalize_lines_h(ln);
+    }
+}
+
+/**
+ *  Compares two points' y-coordinate for the following sorting step.
+ */
+int y_compare(const void *a, const void *b){
+    return pt_y[*(const int *)a] - pt_y[*(const int *)b];
+}
+
+/**
+ * Fills in the ranks and the coordinates in rank order.
+ * Points are pre-sorted by x-coordinate; y_order is sorted here.
+ */
+void rank_points() {
+    int i = 0;
+    qsort(y_order, num_points, sizeof(int), &y_compare);
+    for (; i < num_points; i++) {
+        x_rank[x_order[i]] = i;
+        y_rank[y_order[i]] = i;
+        x_sorted[i] = pt_x[x_order[i]];
+        y_sorted[i] = pt_y[y_order[i]];
+    }
+}
+
+
+/**
+ * Adds a job. Both paths are copied.
+ * @param input - the path of the input file
+ * @param output - the path of the output file
+ */
+void add_job(const char *input, const char *output) {
+    if (num_jobs == jobs_capacity) {
+        jobs_capacity = jobs_capacity == 0 ? 64 : jobs_capacity * 2;
+        jobs = realloc(jobs, sizeof (myjob) * jobs_capacity);
+        if (jobs == NULL) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+    }
+    myjob *job = &jobs[num_jobs++];
+    job->input = strdup(input);
+    job->output = strdup(output);
+    const char *slash = strrchr(job->input, '/');
+    job->name = slash == NULL ? job->input : slash + 1;
+}
+
+void free_jobs() {
+    unsigned int j = 0;
+    for (; j < num_jobs; j++) {
+        free(jobs[j].input);
+        free(jobs[j].output);
+    }
+    free(jobs);
+    jobs = NULL;
+    num_jobs = 0;
+    jobs_capacity = 0;
+}
+
+/**
+ * Adds the job of an input file found by a scan.
+ * The solution of instanceXX.txt goes to greedy_solutionXX.txt, the
+ * solution of any other file name to greedy_<name>.
+ * @param input - the path of the input file
+ * @param output_dir - the directory of the output file
+ */
+void add_found_job(const char *input, const char *output_dir) {
+    const char *slash = strrchr(input, '/');
+    const char *name = slash == NULL ? input : slash + 1;
+    size_t size = strlen(output_dir) + strlen(name) + 32;
+    char *output = malloc(size);
+    if (strncmp(name, "instance", 8) == 0) {
+        snprintf(output, size, "%s/greedy_solution%s", output_dir, name + 8);
+    } else {
+        snprintf(output, size, "%s/greedy_%s", output_dir, name);
+    }
+    add_job(input, output);
+    free(output);
+}
+
+/**
+ * Compares two file names so that runs of digits compare as numbers,
+ * e.g. instance9.txt < instance10.txt < instance100.txt.
+ */
+int name_compare(const char *a, const char *b) {
+    while (*a != '\0' && *b != '\0') {
+        if (isdigit((unsigned char)*a) && isdigit((unsigned char)*b)) {
+            while (*a == '0' && isdigit((unsigned char)a[1])) {
+                a++;
+            }
+            while (*b == '0' && isdigit((unsigned char)b[1])) {
+                b++;
+            }
+            size_t len_a = 0;
+            size_t len_b = 0;
+            while (isdigit((unsigned char)a[len_a])) {
+                len_a++;
+            }
+            while (isdigit((unsigned char)b[len_b])) {
+                len_b++;
+            }
+            if (len_a != len_b) {
+                return len_a < len_b ? -1 : 1;
+            }
+            int diff = strncmp(a, b, len_a);
+            if (diff != 0) {
+                return diff;
+            }
+            a += len_a;
+            b += len_b;
+        } else {
+            if (*a != *b) {
+                return (unsigned char)*a - (unsigned char)*b;
+            }
+            a++;
+            b++;
+        }
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+int job_compare(const void *a, const void *b) {
+    return name_compare(((const myjob *)a)->input, ((const myjob *)b)->input);
+}
+
+/**
+ * Finds every instance*.txt file of a directory with one directory scan.
+ * @param input_dir - the directory to scan
+ * @param output_dir - the directory the solutions go to
+ * @return 1 on success, 0 if the directory cannot be read
+ */
+int find_dir(const char *input_dir, const char *output_dir) {
+    DIR *dir = opendir(input_dir);
+    if (dir == NULL) {
+        printf("Cannot open directory %s\n", input_dir);
+        return 0;
+    }
+    size_t size = strlen(input_dir) + 2;
+    char *path = malloc(size);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (strncmp(entry->d_name, "instance", 8) != 0 || len < 12
+            || strcmp(entry->d_name + len - 4, ".txt") != 0) {
+            continue;
+        }
+        if (strlen(input_dir) + len + 2 > size) {
+            size = strlen(input_dir) + len + 2;
+            path = realloc(path, size);
+        }
+        sprintf(path, "%s/%s", input_dir, entry->d_name);
+        add_found_job(path, output_dir);
+    }
+    closedir(dir);
+    free(path);
+    qsort(jobs, num_jobs, sizeof (myjob), &job_compare);
+    return 1;
+}
+
+/**
+ * Finds every file matching a shell pattern.
+ * @param pattern - the pattern, e.g. "data/run?/inst_*.txt"
+ * @param output_dir - the directory the solutions go to
+ * @return 1 on success, 0 if the pattern cannot be expanded
+ */
+int find_glob(const char *pattern, const char *output_dir) {
+    glob_t found;
+    int status = glob(pattern, GLOB_NOSORT, NULL, &found);
+    if (status == GLOB_NOMATCH) {
+        return 1;
+    }
+    if (status != 0) {
+        printf("Cannot expand %s\n", pattern);
+        return 0;
+    }
+    size_t i = 0;
+    for (; i < found.gl_pathc; i++) {
+        add_found_job(found.gl_pathv[i], output_dir);
+    }
+    globfree(&found);
+    qsort(jobs, num_jobs, sizeof (myjob), &job_compare);
+    return 1;
+}
+
+/**
+ * Reads the jobs listed in a manifest file, one "input output" pair of paths
+ * per line, solved in the order they are listed.
+ * Empty lines and lines starting with # are skipped.
+ * @param manifest - the path of the manifest
+ * @return 1 on success, 0 if the manifest cannot be read or has a bad line
+ */
+int read_manifest(const char *manifest) {
+    FILE *file = fopen(manifest, "r");
+    if (file == NULL) {
+        printf("Cannot open manifest %s\n", manifest);
+        return 0;
+    }
+    char line[4096];
+    char input[2048];
+    char output[2048];
+    int line_num = 0;
+    while (fgets(line, sizeof line, file) != NULL) {
+        line_num++;
+        char first;
+        if (sscanf(line, " %c", &first) != 1 || first == '#') {
+            continue;
+        }
+        if (sscanf(line, "%2047s %2047s", input, output) != 2) {
+            printf("%s:%d: expected an input and an output path\n", manifest, line_num);
+            fclose(file);
+            return 0;
+        }
+        add_job(input, output);
+    }
+    fclose(file);
+    return 1;
+}
+
+/**
+ * Computes the rank signature of the ranked instance into signature[].
+ * For every point, in file order, it holds the dense rank of its x- and
+ * y-coordinate (equal coordinates share a rank), and for every candidate
+ * line the dense rank of the last coordinate on its left or bottom side
+ * (CACHE_NO_SPLIT if no point is on the other side). Coordinates are ranked
+ * as the floats the solver compares, so two instances with the same
+ * signature have the same candidate splits and the same greedy choices.
+ * @return the hash of the signature
+ */
+uint64_t rank_signature() {
+    unsigned int r = 0;
+    unsigned int k = 0;
+    uint32_t dense = 0;
+    uint32_t *point_sig = signature;
+    uint32_t *line_sig = signature + 2 * num_points;
+    int *split = arena_alloc(sizeof (int) * num_all_lines);
+
+    for (r = 0, dense = 0; r < num_points; r++) {
+        dense += r > 0 && (float)x_sorted[r] != (float)x_sorted[r - 1];
+        point_sig[2 * x_order[r]] = dense;
+    }
+    for (r = 0, dense = 0; r < num_points; r++) {
+        dense += r > 0 && (float)y_sorted[r] != (float)y_sorted[r - 1];
+        point_sig[2 * y_order[r] + 1] = dense;
+    }
+    line_splits(split);
+    for (; k < num_all_lines; k++) {
+        if (split[k] < 0) {
+            line_sig[k] = CACHE_NO_SPLIT;
+        } else if (all_lines[k].axis == V) {
+            line_sig[k] = point_sig[2 * x_order[split[k]]];
+        } else {
+            line_sig[k] = point_sig[2 * y_order[split[k]] + 1];
+        }
+    }
+
+    /// FNV-1a over the 32-bit words
+    uint64_t hash = 0xcbf29ce484222325ULL ^ num_points;
+    for (k = 0; k < signature_len; k++) {
+        hash = (hash ^ signature[k]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Builds the path of the cache entry of a hash, DIR/hh/hhhhhhhhhhhhhhhh.rsc,
+ * and creates the subdirectory when asked to.
+ */
+void cache_path(char *path, size_t size, uint64_t hash, int create) {
+    snprintf(path, size, "%s/%02x", cache_dir, (unsigned int)(hash >> 56));
+    if (create) {
+        mkdir(cache_dir, 0755);
+        mkdir(path, 0755);
+    }
+    snprintf(path, size, "%s/%02x/%016llx.rsc", cache_dir, (unsigned int)(hash >> 56),
+             (unsigned long long)hash);
+}
+
+/**
+ * Looks up the ranked and pre-separated instance in the cache. On a hit the
+ * cached choices are committed as final lines, at the midpoints of this
+ * instance's coordinates.
+ * @return 1 on a hit, 0 on a miss
+ */
+int cache_lookup() {
+    char path[4096];
+    uint32_t header[3];
+    signature_len = 2 * num_points + num_all_lines;
+    signature = arena_alloc(sizeof (uint32_t) * signature_len);
+    signature_hash = rank_signature();
+    cache_path(path, sizeof path, signature_hash, 0);
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        cache_misses++;
+        return 0;
+    }
+    int hit = fread(header, sizeof (uint32_t), 3, file) == 3
+              && header[0] == CACHE_MAGIC && header[1] == num_points && header[2] <= num_all_lines;
+    if (hit) {
+        uint32_t *cached = arena_alloc(sizeof (uint32_t) * (signature_len + header[2]));
+        hit = fread(cached, sizeof (uint32_t), signature_len + header[2], file) == signature_len + header[2]
+              && memcmp(cached, signature, sizeof (uint32_t) * signature_len) == 0;
+        unsigned int k = 0;
+        for (; hit && k < header[2]; k++) {
+            uint32_t index = cached[signature_len + k];
+            hit = index < num_all_lines;
+            final_lines[k] = &all_lines[index];
+        }
+        num_lines = hit ? header[2] : 0;
+    }
+    fclose(file);
+    if (hit) {
+        cache_hits++;
+    } else {
+        cache_misses++;
+    }
+    return hit;
+}
+
+/**
+ * Stores the choices of the solved instance under the signature computed by
+ * cache_lookup(). The entry is written to a temporary file and renamed, so
+ * concurrent runs sharing a cache never see a partial entry.
+ */
+void cache_store() {
+    char path[4096];
+    char tmp_path[4200];
+    uint32_t header[3] = {CACHE_MAGIC, num_points, num_lines};
+    unsigned int k = 0;
+    cache_path(path, sizeof path, signature_hash, 1);
+    snprintf(tmp_path, sizeof tmp_path, "%s.%ld.tmp", path, (long)getpid());
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (file == NULL) {
+        printf("Cannot write cache entry %s\n", path);
+        return;
+    }
+    fwrite(header, sizeof (uint32_t), 3, file);
+    fwrite(signature, sizeof (uint32_t), signature_len, file);
+    for (; k < num_lines; k++) {
+        uint32_t index = (uint32_t)(final_lines[k] - all_lines);
+        fwrite(&index, sizeof (uint32_t), 1, file);
+    }
+    if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+        printf("Cannot write cache entry %s\n", path);
+        remove(tmp_path);
+    }
+}
+
+/**
+ * Labels every point with its cell among the committed lines: points in the
+ * same cell get the same label, the id of one of them.
+ * @param label - receives the label of every point, indexed by point id
+ */
+void cell_labels(int *label) {
+    int *split = arena_alloc(sizeof (int) * num_all_lines);
+    char *starts[2];
+    int *slab[2];
+    const int *order[2] = {x_order, y_order};
+    unsigned int i = 0;
+    int a = 0;
+    mycellset cells;
+
+    line_splits(split);
+    for (a = 0; a < 2; a++) {
+        unsigned int r = 0;
+        int s = 0;
+        starts[a] = arena_alloc(num_points);
+        slab[a] = arena_alloc(sizeof (int) * num_points);
+        memset(starts[a], 0, num_points);
+        for (i = 0; i < num_lines; i++) {
+            int k = split[final_lines[i] - all_lines];
+            if (final_lines[i]->axis == a && k >= 0) {
+                starts[a][k + 1] = 1;
+            }
+        }
+        for (; r < num_points; r++) {
+            s += starts[a][r];
+            slab[a][order[a][r]] = s;
+        }
+    }
+
+    cellset_init(&cells, num_points);
+    for (i = 0; i < num_points; i++) {
+        int other = cellset_insert(&cells, cell_key((unsigned int)slab[V][i], (unsigned int)slab[H][i]), (int)i);
+        label[i] = other >= 0 ? other : (int)i;
+    }
+}
+
+/**
+ * Commits, for every two points of a cell that are next to each other in
+ * the order of an axis but apart on it, the candidate line of that axis just
+ * before the second one. The links are not updated.
+ * After cut_cells(V) the points of a cell share their x-coordinate, and after
+ * cut_cells(H) too every cell holds one point.
+ * @param axis - the axis of the lines to commit
+ */
+void cut_cells(int axis) {
+    int *label = arena_alloc(sizeof (int) * num_points);
+    int *last = arena_alloc(sizeof (int) * num_points);
+    const int *order = axis == V ? x_order : y_order;
+    const int *sorted = axis == V ? x_sorted : y_sorted;
+    const unsigned int base = axis == V ? 0 : num_points - 1;
+    unsigned int r = 0;
+    unsigned int first = 0;
+
+    cell_labels(label);
+    memset(last, -1, sizeof (int) * num_points);
+    for (; r < num_points; r++) {
+        /// first is the first rank of the coordinate of rank r
+        if (r > 0 && (float)sorted[r] != (float)sorted[r - 1]) {
+            first = r;
+        }
+        int cell = label[order[r]];
+        if (last[cell] >= 0 && (float)sorted[last[cell]] != (float)sorted[r]) {
+            unsigned int k = base + first - 1;
+            if (lines[k] != NULL) {
+                final_lines[num_lines++] = lines[k];
+                lines[k] = NULL;
+            }
+        }
+        last[cell] = (int)r;
+    }
+}
+
+/**
+ * splitmix64, a small generator whose whole state is one word, so that every
+ * randomized run is reproduced by its seed.
+ */
+static inline uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Returns a random number in [0, bound).
+ */
+static inline unsigned int random_below(uint64_t *state, unsigned int bound) {
+    return (unsigned int)(((next_random(state) >> 32) * bound) >> 32);
+}
+
+/**
+ * Picks the line to commit in a randomized restart: at random among the lines
+ * that break at least (1 - near_max) times the most links, so with near_max 0
+ * among the lines the deterministic greedy breaks its ties between.
+ * @return the index of the line in lines, or -1 if the budget ran out
+ */
+int pick_random_line() {
+    long long most = 0;
+    unsigned int count = 0;
+    unsigned int j = 0;
+    for (; j < num_all_lines; j++) {
+        if (j % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            return -1;
+        }
+        gains[j] = links_to_break(lines[j]);
+        if (gains[j] > most) {
+            most = gains[j];
+        }
+    }
+    long long threshold = most - (long long)(near_max * most);
+    if (threshold < 1) {
+        threshold = 1;
+    }
+    for (j = 0; j < num_all_lines; j++) {
+        count += gains[j] >= threshold;
+    }
+    unsigned int pick = random_below(&rng_state, count);
+    for (j = 0; gains[j] < threshold || pick > 0; j++) {
+        pick -= gains[j] >= threshold;
+    }
+    return (int)j;
+}
+
+/**
+ * Commits, for every preset line that splits the points, the candidate
+ * line splitting them the same way.
+ */
+void commit_presets() {
+    unsigned int i = 0;
+    presets_committed = 0;
+    for (; i < num_presets; i++) {
+        myline ln = preset_lines[i];
+        int closest = closest_point(&ln);
+        if (closest >= 0) {
+            unsigned int k = (ln.axis == V ? 0 : num_points - 1) + (unsigned int)closest;
+            if (lines[k] != NULL) {
+                finalize_lines(lines[k]);
+                lines[k] = NULL;
+                presets_committed++;
+            }
+        }
+    }
+}
+
+/**
+ * Finds the line that can break the most links by evaluating every
+ * candidate, the first one on ties.
+ * @return the index of the line in lines, or -1 if the budget ran out
+ */
+int scan_best_line() {
+    long long num_link = links_to_break(lines[0]);
+    int line_index = 0;
+    int j;
+    for (j = 1; j < num_all_lines; j++) {
+        if (j % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            return -1;
+        }
+        long long temp = links_to_break(lines[j]);
+        if (temp > num_link) {
+            line_index = j;
+            num_link = temp;
+        }
+    }
+    return line_index;
+}
+
+/**
+ * Tells whether candidate a beats candidate b in the tree: a greater gain,
+ * or an equal gain and a lower index; -1 is an empty leaf.
+ */
+static inline int gain_beats(int a, int b) {
+    return b < 0 || (a >= 0 && (gains[a] > gains[b] || (gains[a] == gains[b] && a < b)));
+}
+
+/**
+ * Builds the tree over the gains of count candidates, in O(count), all
+ * stamped as evaluated at stamp.
+ */
+void gain_tree_build(unsigned int count, unsigned int stamp) {
+    unsigned int k = 0;
+    gain_leaves = 1;
+    while (gain_leaves < count) {
+        gain_leaves <<= 1;
+    }
+    gain_tree = arena_alloc(sizeof (int) * 2 * gain_leaves);
+    gain_stamp = arena_alloc(sizeof (unsigned int) * (count + 1));
+    for (; k < gain_leaves; k++) {
+        if (k < count) {
+            gain_stamp[k] = stamp;
+        }
+        gain_tree[gain_leaves + k] = k < count ? (int)k : -1;
+    }
+    for (k = gain_leaves - 1; k >= 1; k--) {
+        int a = gain_tree[2 * k];
+        int b = gain_tree[2 * k + 1];
+        gain_tree[k] = gain_beats(a, b) ? a : b;
+    }
+}
+
+/**
+ * Evaluates every candidate once and builds the tree over their gains, or
+ * stops as soon as the budget is spent, leaving no tree.
+ */
+void gain_tree_init() {
+    unsigned int k = 0;
+    for (; k < num_all_lines; k++) {
+        if (k % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            return;
+        }
+        gains[k] = links_to_break(lines[k]);
+    }
+    gain_tree_build(num_all_lines, num_lines);
+}
+
+/**
+ * Replays the matches on the path of candidate k after its gain changed, in O(log n).
+ */
+void gain_tree_update(int k) {
+    unsigned int t = (gain_leaves + (unsigned int)k) / 2;
+    for (; t >= 1; t /= 2) {
+        int a = gain_tree[2 * t];
+        int b = gain_tree[2 * t + 1];
+        gain_tree[t] = gain_beats(a, b) ? a : b;
+    }
+}
+
+/**
+ * Finds the same line as scan_best_line() while evaluating few candidates.
+ * Committing a line only breaks links, so the gain of a candidate never
+ * grows and a gain evaluated before is a bound on the current one. The
+ * candidate leading the tree is evaluated again until the leader's gain is
+ * current: then no other candidate can have a greater gain, nor an equal one
+ * at a lower index, as each is bounded by a gain that loses to the leader.
+ * @return the index of the line in lines, or -1 if the budget ran out
+ */
+int tree_best_line() {
+    int k = gain_tree[1];
+    unsigned int evaluated = 0;
+    while (gain_stamp[k] != num_lines) {
+        if (++evaluated % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            return -1;
+        }
+        gains[k] = links_to_break(lines[k]);
+        gain_stamp[k] = num_lines;
+        gain_tree_update(k);
+        k = gain_tree[1];
+    }
+    return k;
+}
+
+/**
+ * Returns the square root of v >= 0 by Newton's method, so that the build
+ * needs no libm.
+ */
+double square_root(double v) {
+    double root = v > 1 ? v : 1;
+    int step = 0;
+    if (v <= 0) {
+        return 0;
+    }
+    for (; step < 64; step++) {
+        double next = (root + v / root) / 2;
+        if (next >= root) {
+            break;
+        }
+        root = next;
+    }
+    return root;
+}
+
+/**
+ * Allocates the buffers of approximate gains, bounds the gain of every
+ * candidate by the pairs across it, left times right, and builds the tree
+ * over these bounds as not yet evaluated. The sampling is seeded so that the
+ * same instance and seed give the same lines.
+ */
+void approx_init() {
+    unsigned int k = 0;
+    int a = 0;
+    approx_sample = arena_alloc(sizeof (int) * approx_samples);
+    for (; a < 2; a++) {
+        approx_slab[a][0] = arena_alloc(sizeof (unsigned int) * approx_samples);
+        approx_slab[a][1] = arena_alloc(sizeof (unsigned int) * approx_samples);
+        approx_counts[a] = arena_alloc(sizeof (double) * approx_samples);
+    }
+    lower_bounds = arena_alloc(sizeof (double) * num_all_lines);
+    gain_exact = arena_alloc(num_all_lines);
+    live_points = arena_alloc(sizeof (int) * num_points);
+    for (num_live = 0; num_live < num_points; num_live++) {
+        live_points[num_live] = (int)num_live;
+    }
+    memset(gain_exact, 1, num_all_lines);
+    if (storage != INDEX) {
+        line_split = arena_alloc(sizeof (int) * num_all_lines);
+        line_splits(line_split);
+    }
+    for (; k < num_all_lines; k++) {
+        const long long left = line_split[k] + 1;
+        gains[k] = lines[k] == NULL || line_split[k] < 0 ? -1 : left * ((long long)num_points - left);
+    }
+    gain_tree_build(num_all_lines, UINT_MAX);
+    approx_rng = restart_seed ^ ((uint64_t)num_points << 32);
+    approx_drawn = UINT_MAX;
+}
+
+/**
+ * Returns the slab [*from, *to) of INDEX storage holding a rank.
+ */
+static inline void rank_slab(int axis, unsigned int rank, unsigned int *from, unsigned int *to) {
+    unsigned int lo = 0;
+    unsigned int hi = num_slabs[axis];
+    while (hi - lo > 1) {
+        unsigned int mid = (lo + hi) / 2;
+        if ((unsigned int)slab_starts[axis][mid] <= rank) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    *from = (unsigned int)slab_starts[axis][lo];
+    *to = (unsigned int)slab_starts[axis][lo + 1];
+}
+
+/**
+ * Counts the points still linked to sampled point i on the other side of the
+ * split after rank closest of an axis. With INDEX storage these are the
+ * points of its cell beyond the split, counted in O(log n); with FULL
+ * storage its row of links against the mask of the other side, in O(n / 64).
+ * @param above - the mask of the points beyond the split, FULL only
+ * @param below - the mask of the points up to the split, FULL only
+ */
+static inline unsigned int sample_links(int axis, int closest, unsigned int i,
+                                        const myword *above, const myword *below) {
+    const int id = approx_sample[i];
+    const unsigned int rank = (unsigned int)(axis == V ? x_rank[id] : y_rank[id]);
+    const unsigned int split = (unsigned int)closest + 1;
+    if (storage != INDEX) {
+        return kernel->count_links(links + row_base[id], rank < split ? above : below, num_words);
+    }
+    unsigned int from = approx_slab[axis][0][i];
+    unsigned int to = approx_slab[axis][1][i];
+    if (split <= from || split >= to) {
+        return 0;
+    }
+    if (rank < split) {
+        from = split;
+    } else {
+        to = split;
+    }
+    if (axis == V) {
+        return (unsigned int)range_count(from, to, approx_slab[H][0][i], approx_slab[H][1][i]);
+    }
+    return (unsigned int)range_count(approx_slab[V][0][i], approx_slab[V][1][i], from, to);
+}
+
+/**
+ * Draws the sample of points the gains of this step are estimated from, out
+ * of the pool of points that may still be linked. A point drawn once its
+ * cell holds it alone stays in the sample, with no links, but is dropped
+ * from the pool for the next steps.
+ */
+void approx_draw() {
+    unsigned int i = 0;
+    unsigned int pool = num_live;
+    approx_pool = num_live;
+    for (; i < approx_samples; i++) {
+        const unsigned int j = (unsigned int)random_below(&approx_rng, pool);
+        const int id = live_points[j];
+        int linked = 0;
+        approx_sample[i] = id;
+        if (storage == INDEX) {
+            rank_slab(V, (unsigned int)x_rank[id], &approx_slab[V][0][i], &approx_slab[V][1][i]);
+            rank_slab(H, (unsigned int)y_rank[id], &approx_slab[H][0][i], &approx_slab[H][1][i]);
+            linked = range_count(approx_slab[V][0][i], approx_slab[V][1][i],
+                                 approx_slab[H][0][i], approx_slab[H][1][i]) > 1;
+        } else {
+            unsigned int w = 0;
+            for (; w < num_words && !linked; w++) {
+                linked = links[row_base[id] + w] != 0;
+            }
+        }
+        if (!linked && j < num_live) {
+            /// the slot past num_live keeps the point drawable on this step
+            num_live--;
+            live_points[j] = live_points[num_live];
+            live_points[num_live] = id;
+        }
+    }
+    approx_drawn = num_lines;
+}
+
+/**
+ * Counts, for every sampled point, its links across candidate k into counts.
+ * @return how many sampled points have links across
+ */
+unsigned int approx_count(unsigned int k, double *counts) {
+    const int closest = line_split[k];
+    const int axis = all_lines[k].axis;
+    unsigned int seen = 0;
+    unsigned int i = 0;
+    if (approx_drawn != num_lines) {
+        approx_draw();
+    }
+    if (storage != INDEX) {
+        /// a vertical mask is only written where it is set, so it is cleared first
+        unsigned int lo, hi;
+        memset(side_mask, 0, sizeof (myword) * num_words);
+        memset(other_mask, 0, sizeof (myword) * num_words);
+        build_side_mask(axis, side_mask, closest + 1, num_points, &lo, &hi);
+        build_side_mask(axis, other_mask, 0, closest + 1, &lo, &hi);
+    }
+    for (; i < approx_samples; i++) {
+        counts[i] = sample_links(axis, closest, i, side_mask, other_mask);
+        seen += counts[i] > 0;
+    }
+    return seen;
+}
+
+/**
+ * Estimates a gain, or weighted difference of gains, from the counts of the
+ * sample. Every pair across a line is seen from both its points, so half the
+ * number of linked points times the mean count of a sampled point is an unbiased estimate of the
+ * gain, off by less than three standard errors of the sample almost always.
+ * The counts of two lines on the same sample go up and down together, so
+ * their difference point by point varies far less than either.
+ * @param others - the counts subtracted, weighted, from counts, or NULL
+ */
+void approx_interval(const double *counts, const double *others, double weight,
+                     double *estimate, double *half_width) {
+    const double scale = approx_pool / 2.0;
+    double sum = 0;
+    double sum_sq = 0;
+    unsigned int i = 0;
+    for (; i < approx_samples; i++) {
+        double c = others == NULL ? counts[i] : counts[i] - weight * others[i];
+        sum += c;
+        sum_sq += c * c;
+    }
+    double mean = sum / approx_samples;
+    double var = sum_sq / approx_samples - mean * mean;
+    *estimate = scale * mean;
+    *half_width = 3 * scale * square_root(var > 0 ? var / approx_samples : 0);
+}
+
+/**
+ * Returns the candidate the tree would lead with if candidate k were out of
+ * it: the best of the subtrees beside the path of k, in O(log n).
+ */
+int gain_runner_up(int k) {
+    unsigned int t = gain_leaves + (unsigned int)k;
+    int runner = -1;
+    for (; t > 1; t /= 2) {
+        int other = gain_tree[t ^ 1];
+        if (gain_beats(other, runner)) {
+            runner = other;
+        }
+    }
+    return runner;
+}
+
+/**
+ * Estimates the gain of candidate k on this step and bounds it by the upper
+ * end of the interval, or evaluates it exactly when too few sampled points
+ * have links across it for the interval to hold.
+ */
+void approx_evaluate(int k) {
+    double estimate, half_width;
+    if (approx_count((unsigned int)k, approx_counts[0]) >= APPROX_MIN_SEEN) {
+        approx_interval(approx_counts[0], NULL, 0, &estimate, &half_width);
+        const long long upper = (long long)(estimate + half_width) + 1;
+        /// an estimated bound is off now and then, so a new estimate replaces it
+        if (!gain_exact[k] || upper < gains[k]) {
+            gains[k] = upper;
+        }
+        lower_bounds[k] = estimate - half_width;
+        gain_exact[k] = 0;
+    } else {
+        gains[k] = links_to_break(lines[k]);
+        gain_exact[k] = 1;
+    }
+    gain_stamp[k] = num_lines;
+    gain_tree_update(k);
+}
+
+/**
+ * Picks the line to commit like tree_best_line(), with estimates in place of
+ * most exact evaluations. A stale leader is estimated, and the upper end of
+ * its confidence interval becomes its bound. A freshly estimated leader is
+ * taken when its gain is shown to be at least 1 - approx_error times that of
+ * the runner-up, by the interval of their weighted difference on the sample
+ * or against an exact gain of the runner-up; otherwise the intervals overlap
+ * and its gain is confirmed exactly.
+ * @return the index of the line in lines, or -1 if the budget ran out
+ */
+int approx_best_line() {
+    unsigned int evaluated = 0;
+    for (;;) {
+        const int k = gain_tree[1];
+        if (++evaluated % BUDGET_CHECK_EVERY == 0 && budget_spent()) {
+            return -1;
+        }
+        if (gain_stamp[k] == num_lines && gain_exact[k]) {
+            approx_confirmed++;
+            return k;
+        }
+        if (gain_stamp[k] != num_lines) {
+            approx_evaluate(k);
+            continue;
+        }
+        const int runner = gain_runner_up(k);
+        if (runner >= 0 && gain_stamp[runner] != num_lines) {
+            /// a stale bound is loose, so the runner-up is estimated before it is compared
+            approx_evaluate(runner);
+            continue;
+        }
+        if (runner < 0 || gain_exact[runner]) {
+            const double rival = runner < 0 ? 0 : (double)gains[runner];
+            if (lower_bounds[k] > 0 && lower_bounds[k] >= (1 - approx_error) * rival) {
+                approx_picks++;
+                return k;
+            }
+        } else if (lower_bounds[k] > 0) {
+            double margin, half_width;
+            approx_count((unsigned int)k, approx_counts[0]);
+            approx_count((unsigned int)runner, approx_counts[1]);
+            approx_interval(approx_counts[0], approx_counts[1], 1 - approx_error, &margin, &half_width);
+            if (margin - half_width >= 0) {
+                approx_picks++;
+                return k;
+            }
+        }
+        gains[k] = links_to_break(lines[k]);
+        gain_exact[k] = 1;
+        gain_tree_update(k);
+    }
+}
+
+/**
+ * Prints how many cells of the committed lines hold how many points.
+ */
+void print_occupancy() {
+    int *label = arena_alloc(sizeof (int) * num_points);
+    unsigned int *size = arena_alloc(sizeof (unsigned int) * num_points);
+    unsigned int *cells = arena_alloc(sizeof (unsigned int) * (num_points + 1));
+    unsigned int i = 0;
+    const char *sep = "";
+    cell_labels(label);
+    memset(size, 0, sizeof (unsigned int) * num_points);
+    memset(cells, 0, sizeof (unsigned int) * (num_points + 1));
+    for (; i < num_points; i++) {
+        size[label[i]]++;
+    }
+    for (i = 0; i < num_points; i++) {
+        cells[size[i]] += label[i] == (int)i;
+    }
+    printf("  cells by number of points:");
+    for (i = 1; i <= num_points; i++) {
+        if (cells[i] > 0) {
+            printf("%s %u with %u", sep, cells[i], i);
+            sep = ",";
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * Runs the greedy algorithm on the loaded instance. With a budget the clock
+ * is read between commits and every few candidates or rows inside the
+ * linking and the evaluation of candidates; once the budget is spent the
+ * lines committed so far are kept and the rest is cut by cut_cells().
+ */
+void solve() {
+    const int partial = max_lines > 0 || target_fraction > 0;
+    /// UPPER storage keeps a pair in one row only, so a point's links cannot be counted alone
+    const int approx = approx_samples > 0 && storage != UPPER && !randomized;
+    const int tree = select_tree && !randomized && !approx;
+    clock_gettime(CLOCK_MONOTONIC, &solve_start);
+    out_of_time = 0;
+    stopped_early = 0;
+    approx_picks = 0;
+    approx_confirmed = 0;
+
+    /// Sort the points by y-coordinate. Points are pre-sorted by x-coordinate.
+    rank_points();
+
+    pre_separate();
+    if (cache_dir != NULL && !randomized && !partial && !approx && num_presets == 0 && cache_lookup()) {
+        return;
+    }
+    if (storage == INDEX) {
+        index_points();
+    } else {
+        link_points();
+    }
+    if (!out_of_time) {
+        commit_presets();
+    }
+    if (randomized || tree || approx) {
+        gains = arena_alloc(sizeof (long long) * num_all_lines);
+    }
+    if (tree && !out_of_time) {
+        gain_tree_init();
+    }
+    if (approx && !out_of_time) {
+        approx_init();
+    }
+
+    const unsigned long long total_edges = num_edges;
+    while (num_edges > 0 && !out_of_time) {
+        if ((max_lines > 0 && num_lines >= max_lines)
+            || (target_fraction > 0 && total_edges - num_edges >= target_fraction * total_edges)) {
+            stopped_early = 1;
+            break;
+        }
+        if (budget_spent()) {
+            break;
+        }
+        int line_index = randomized ? pick_random_line()
+                         : approx ? approx_best_line() : tree ? tree_best_line() : scan_best_line();
+        if (line_index < 0) {
+            break;
+        }
+        finalize_lines(lines[line_index]);
+        lines[line_index] = NULL;
+        if (tree || approx) {
+            gains[line_index] = -1;
+            gain_tree_update(line_index);
+        }
+    }
+    pairs_left = num_edges;
+    if (out_of_time && partial) {
+        /// a partial solution is wanted anyway, so nothing is cut
+        stopped_early = 1;
+    } else if (out_of_time) {
+        /// keeps the lines committed so far and cuts what is left
+        greedy_lines = num_lines;
+        cut_cells(V);
+        cut_cells(H);
+        return;
+    }
+    if (cache_dir != NULL && !randomized && !stopped_early && !approx && num_presets == 0) {
+        cache_store();
+    }
+}
+
+int int_compare(const void *a, const void *b) {
+    int ia = *(const int *)a;
+    int ib = *(const int *)b;
+    return (ia > ib) - (ia < ib);
+}
+
+/**
+ * Removes the committed lines that are not needed once the others are in
+ * place, trying them in the order they were committed.
+ * The lines of an axis cut the points, in rank order, into slabs. A line is
+ * not needed if the two slabs it divides can be merged without two of their
+ * points sharing a slab of the other axis, which is tested by hashing the
+ * cells of only those points, in O(n) at worst.
+ * Removing a line only merges cells, so a line found needed stays needed and
+ * one pass reaches the fixpoint.
+ * @return the number of removed lines
+ */
+unsigned int prune_lines() {
+    int *split = arena_alloc(sizeof (int) * num_all_lines);
+    const int *order[2] = {x_order, y_order};
+    int *bounds[2];
+    int *slab[2];
+    unsigned int num_bounds[2] = {1, 1};
+    unsigned int i = 0;
+    unsigned int kept = 0;
+    int a = 0;
+    mycellset cells;
+
+    line_splits(split);
+    cellset_init(&cells, num_points);
+    for (a = 0; a < 2; a++) {
+        bounds[a] = arena_alloc(sizeof (int) * (num_lines + 2));
+        slab[a] = arena_alloc(sizeof (int) * num_points);
+        bounds[a][0] = 0;
+    }
+
+    /// the ranks where the slabs of each axis start, then the slab of every point
+    for (i = 0; i < num_lines; i++) {
+        int s = split[final_lines[i] - all_lines];
+        if (s >= 0) {
+            a = final_lines[i]->axis;
+            bounds[a][num_bounds[a]++] = s + 1;
+        }
+    }
+    for (a = 0; a < 2; a++) {
+        unsigned int r = 0;
+        unsigned int next = 1;
+        qsort(bounds[a] + 1, num_bounds[a] - 1, sizeof (int), int_compare);
+        bounds[a][num_bounds[a]] = (int)num_points;
+        for (; r < num_points; r++) {
+            if (next < num_bounds[a] && bounds[a][next] == (int)r) {
+                next++;
+            }
+            slab[a][order[a][r]] = (int)next - 1;
+        }
+    }
+
+    for (i = 0; i < num_lines; i++) {
+        int s = split[final_lines[i] - all_lines];
+        a = final_lines[i]->axis;
+        if (s >= 0) {
+            int b = s + 1;
+            int *found = bsearch(&b, bounds[a] + 1, num_bounds[a] - 1, sizeof (int), int_compare);
+            unsigned int j = (unsigned int)(found - bounds[a]);
+            int r = bounds[a][j - 1];
+            int needed = 0;
+
+            cellset_clear(&cells, (unsigned int)(bounds[a][j + 1] - r));
+            for (; r < bounds[a][j + 1] && !needed; r++) {
+                int id = order[a][r];
+                needed = cellset_insert(&cells, cell_key(0, (unsigned int)slab[1 - a][id]), id) >= 0;
+            }
+            if (needed) {
+                final_lines[kept++] = final_lines[i];
+                continue;
+            }
+
+            /// merges slab j into slab j - 1
+            unsigned int p = 0;
+            memmove(&bounds[a][j], &bounds[a][j + 1], sizeof (int) * (num_bounds[a] - j));
+            num_bounds[a]--;
+            for (; p < num_points; p++) {
+                slab[a][p] -= slab[a][p] >= (int)j;
+            }
+        }
+    }
+
+    unsigned int removed = num_lines - kept;
+    num_lines = kept;
+    return removed;
+}
+
+/**
+ * The loop of a pool thread: runs tasks of the current batch until the pool stops.
+ */
+void *pool_worker(void *arg) {
+    myworker *w = arg;
+    mypool *pool = w->pool;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->next >= pool->count) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        unsigned int index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(pool->arg, index, w->id);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->finished == pool->count) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    arena_free();
+    return NULL;
+}
+
+void pool_init(mypool *pool, int num_threads) {
+    int i = 0;
+    pool->workers = malloc(sizeof (myworker) * num_threads);
+    pool->num_threads = num_threads;
+    pool->task = NULL;
+    pool->arg = NULL;
+    pool->next = 0;
+    pool->count = 0;
+    pool->finished = 0;
+    pool->stop = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (; i < num_threads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        pthread_create(&pool->workers[i].thread, NULL, pool_worker, &pool->workers[i]);
+    }
+}
+
+/**
+ * Runs task(arg, index, worker) for every index below count on the threads
+ * of the pool and returns when all have finished. worker is the number of
+ * the thread running the task, below the number of threads.
+ */
+void pool_run(mypool *pool, void (*task)(void *, unsigned int, int), void *arg, unsigned int count) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->next = 0;
+    pool->count = count;
+    pool->finished = 0;
+    pthread_cond_broadcast(&pool->work);
+    while (pool->finished < count) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_destroy(mypool *pool) {
+    int i = 0;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (; i < pool->num_threads; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    free(pool->workers);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+}
+
+/**
+ * Runs restart r of an instance on a pool thread, with the solver state of
+ * that thread, and keeps its solution if it is the best the thread has found.
+ * A thread runs its restarts in increasing order, so it keeps the first of
+ * equally good solutions.
+ */
+void restart_task(void *arg, unsigned int r, int worker) {
+    myrestarts *rs = arg;
+    myrestart *best = &rs->best[worker];
+    unsigned int pruned = 0;
+
+    uint64_t stream = r;
+    load_instance(rs->inst);
+    randomized = r > 0;
+    rng_state = restart_seed ^ next_random(&stream);
+    solve();
+    if (prune) {
+        pruned = prune_lines();
+    }
+    rs->num_lines[r] = num_lines;
+    if (best->index < 0 || num_lines < best->sol.num_lines) {
+        store_solution(rs->inst->job, &best->sol);
+        best->index = (int)r;
+        best->pruned = pruned;
+        best->out_of_time = out_of_time;
+        best->stopped_early = stopped_early;
+    }
+    restore();
+    randomized = 0;
+}
+
+/**
+ * Solves an instance num_restarts times on the restart pool: restart 0 is
+ * the deterministic greedy, the others pick at random among the best lines.
+ * The solution with the fewest lines is kept, the one of the lowest restart
+ * among equals, so the result only depends on the seed.
+ * @param inst - the instance
+ * @param sol - receives the best solution
+ * @return 1 if the best solution leaves points sharing cells, else 0
+ */
+int solve_restarts(const myinstance *inst, mysolution *sol) {
+    myrestarts rs;
+    int w = 0;
+    int chosen = 0;
+    rs.inst = inst;
+    rs.best = calloc(restart_pool->num_threads, sizeof (myrestart));
+    rs.num_lines = malloc(sizeof (unsigned int) * num_restarts);
+    for (; w < restart_pool->num_threads; w++) {
+        rs.best[w].index = -1;
+    }
+    pool_run(restart_pool, restart_task, &rs, (unsigned int)num_restarts);
+
+    for (w = 1; w < restart_pool->num_threads; w++) {
+        const myrestart *b = &rs.best[w];
+        const myrestart *c = &rs.best[chosen];
+        if (b->index >= 0 && (c->index < 0 || b->sol.num_lines < c->sol.num_lines
+                              || (b->sol.num_lines == c->sol.num_lines && b->index < c->index))) {
+            chosen = w;
+        }
+    }
+    myrestart *best = &rs.best[chosen];
+    if (report_solves) {
+        printf("%s: restart %d of %d is best with %u lines, the deterministic greedy has %u.\n",
+               inst->job->name, best->index, num_restarts, best->sol.num_lines, rs.num_lines[0]);
+    }
+    if (best->out_of_time) {
+        printf("%s ran out of time; the rest was cut.\n", inst->job->name);
+        num_out_of_time++;
+    }
+    num_pruned += best->pruned;
+    const int partial = best->stopped_early;
+
+    /// hands the best solution over, keeping the buffer of sol for a thread
+    mysolution swap = *sol;
+    *sol = best->sol;
+    best->sol = swap;
+    for (w = 0; w < restart_pool->num_threads; w++) {
+        free(rs.best[w].sol.lines);
+    }
+    free(rs.best);
+    free(rs.num_lines);
+    return partial;
+}
+
+/**
+ * Chooses the boundaries of the buckets of one axis, at about every
+ * n / grid points, and puts every point into its bucket. A boundary lies
+ * halfway between two distinct coordinates, like a candidate line of the
+ * solver, so buckets can hold fewer or more points where coordinates repeat.
+ * @param sorted - the coordinates of the axis in ascending order
+ * @param coords - the coordinates of the axis, indexed by point id
+ */
+void coarse_buckets(mycoarse *c, int axis, const int *sorted, const int *coords, unsigned int n, unsigned int grid) {
+    unsigned int last = 0;
+    unsigned int i = 1;
+    c->bounds[axis] = grow_array(NULL, sizeof (double) * grid);
+    c->buckets[axis] = 1;
+    for (; i < grid; i++) {
+        unsigned int r = (unsigned int)((unsigned long long)i * n / grid);
+        while (r < n && (float)sorted[r - 1] == (float)sorted[r]) {
+            r++;
+        }
+        if (r >= n) {
+            break;
+        }
+        if (r > last) {
+            c->bounds[axis][c->buckets[axis] - 1] = ((float)sorted[r - 1] + (float)sorted[r]) / 2;
+            c->buckets[axis]++;
+            last = r;
+        }
+    }
+    c->bucket[axis] = grow_array(NULL, sizeof (unsigned int) * n);
+    for (i = 0; i < n; i++) {
+        c->bucket[axis][i] = slab_index(c->bounds[axis], c->buckets[axis] - 1, coords[i]);
+    }
+}
+
+/**
+ * Counts the points in buckets [x_from, x_to) x [y_from, y_to), in O(1).
+ */
+static inline unsigned long long coarse_count(const mycoarse *c, unsigned int x_from, unsigned int x_to,
+                                              unsigned int y_from, unsigned int y_to) {
+    const unsigned int stride = c->buckets[H] + 1;
+    return (unsigned long long)c->prefix[x_to * stride + y_to] - c->prefix[x_from * stride + y_to]
+           - c->prefix[x_to * stride + y_from] + c->prefix[x_from * stride + y_from];
+}
+
+/**
+ * Returns the axis of coarse candidate k and, in *i, the bucket its
+ * boundary starts; the vertical candidates come first.
+ */
+static inline int coarse_candidate(const mycoarse *c, unsigned int k, unsigned int *i) {
+    int axis = k < c->buckets[V] - 1 ? V : H;
+    *i = (axis == V ? k : k - (c->buckets[V] - 1)) + 1;
+    return axis;
+}
+
+/**
+ * Returns the pairs of points a coarse candidate separates that share a
+ * cell of the committed boundaries, as index_links() does for points, or
+ * -1 if it is committed. Points of one bucket count as one place.
+ */
+long long coarse_gain(const mycoarse *c, unsigned int k) {
+    unsigned int i;
+    const int axis = coarse_candidate(c, k, &i);
+    const unsigned int *starts = c->starts[axis];
+    const unsigned int *other = c->starts[1 - axis];
+    unsigned long long gain = 0;
+    unsigned int lo = 0;
+    unsigned int hi = c->num_slabs[axis];
+    unsigned int j = 0;
+    while (hi - lo > 1) {
+        unsigned int mid = (lo + hi) / 2;
+        if (starts[mid] <= i) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    if (starts[lo] == i) {
+        return -1;
+    }
+    for (; j < c->num_slabs[1 - axis]; j++) {
+        if (axis == V) {
+            gain += coarse_count(c, starts[lo], i, other[j], other[j + 1])
+                    * coarse_count(c, i, starts[lo + 1], other[j], other[j + 1]);
+        } else {
+            gain += coarse_count(c, other[j], other[j + 1], starts[lo], i)
+                    * coarse_count(c, other[j], other[j + 1], i, starts[lo + 1]);
+        }
+    }
+    return (long long)gain;
+}
+
+/**
+ * Runs the greedy on the buckets: commits the boundary separating the most
+ * pairs, picked from the gain tree, until none separates at least
+ * coarse_cell^2 / 4 pairs, about what halving a cell of coarse_cell points
+ * would. The tree comes from the arena.
+ * @return the number of committed boundaries
+ */
+unsigned int coarse_greedy(mycoarse *c) {
+    const unsigned int count = c->buckets[V] - 1 + c->buckets[H] - 1;
+    const long long threshold = (long long)coarse_cell * coarse_cell / 4 > 0
+                                ? (long long)coarse_cell * coarse_cell / 4 : 1;
+    unsigned int committed = 0;
+    unsigned int k = 0;
+    int a = 0;
+    for (; a < 2; a++) {
+        c->starts[a] = grow_array(NULL, sizeof (unsigned int) * (c->buckets[a] + 1));
+        c->starts[a][0] = 0;
+        c->starts[a][1] = c->buckets[a];
+        c->num_slabs[a] = 1;
+    }
+    gains = arena_alloc(sizeof (long long) * (count + 1));
+    for (; k < count; k++) {
+        gains[k] = coarse_gain(c, k);
+    }
+    gain_tree_build(count, 0);
+    while (count > 0) {
+        int best = gain_tree[1];
+        while (gain_stamp[best] != committed) {
+            gains[best] = coarse_gain(c, (unsigned int)best);
+            gain_stamp[best] = committed;
+            gain_tree_update(best);
+            best = gain_tree[1];
+        }
+        if (gains[best] < threshold) {
+            break;
+        }
+        unsigned int i;
+        a = coarse_candidate(c, (unsigned int)best, &i);
+        unsigned int *starts = c->starts[a];
+        unsigned int j = c->num_slabs[a];
+        for (; starts[j] > i; j--) {
+            starts[j + 1] = starts[j];
+        }
+        starts[j + 1] = i;
+        c->num_slabs[a]++;
+        gains[best] = -1;
+        gain_tree_update(best);
+        committed++;
+    }
+    return committed;
+}
+
+void coarse_free(mycoarse *c) {
+    int a = 0;
+    for (; a < 2; a++) {
+        free(c->bounds[a]);
+        free(c->bucket[a]);
+        free(c->starts[a]);
+    }
+    free(c->prefix);
+}
+
+/**
+ * Inserts a line into the sorted coordinates of its axis.
+ */
+void insert_coord(double **coords, unsigned int *count, unsigned int *capacity, double coord) {
+    unsigned int at = 0;
+    unsigned int end = *count;
+    if (*count == *capacity) {
+        *capacity = *capacity == 0 ? 64 : 2 * *capacity;
+        *coords = grow_array(*coords, sizeof (double) * *capacity);
+    }
+    while (at < end) {
+        unsigned int mid = (at + end) / 2;
+        if ((*coords)[mid] < coord) {
+            at = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    memmove(&(*coords)[at + 1], &(*coords)[at], sizeof (double) * (*count - at));
+    (*coords)[at] = coord;
+    (*count)++;
+}
+
+void add_solution_line(mysolution *sol, int axis, float coord) {
+    if (sol->num_lines == sol->capacity) {
+        sol->capacity = sol->capacity == 0 ? 64 : 2 * sol->capacity;
+        sol->lines = grow_array(sol->lines, sizeof (myline) * sol->capacity);
+    }
+    sol->lines[sol->num_lines].axis = axis;
+    sol->lines[sol->num_lines].coord = coord;
+    sol->num_lines++;
+}
+
+/**
+ * Removes the lines of a solution made redundant by its other lines, see
+ * prune_lines(), by committing the candidate line of the solver that splits
+ * the points the same way as each line.
+ * @return the number of removed lines
+ */
+unsigned int prune_solution(const myinstance *inst, mysolution *sol) {
+    unsigned int i = 0;
+    load_instance(inst);
+    rank_points();
+    pre_separate();
+    for (; i < sol->num_lines; i++) {
+        int closest = closest_point(&sol->lines[i]);
+        if (closest >= 0) {
+            unsigned int k = (sol->lines[i].axis == V ? 0 : num_points - 1) + (unsigned int)closest;
+            final_lines[num_lines++] = &all_lines[k];
+        }
+    }
+    prune_lines();
+    unsigned int removed = sol->num_lines - num_lines;
+    for (i = 0; i < num_lines; i++) {
+        sol->lines[i] = *final_lines[i];
+    }
+    sol->num_lines = num_lines;
+    restore();
+    return removed;
+}
+
+int uint64_compare(const void *a, const void *b) {
+    uint64_t ua = *(const uint64_t *)a;
+    uint64_t ub = *(const uint64_t *)b;
+    return (ua > ub) - (ua < ub);
+}
+
+/**
+ * Solves an instance in two levels. The points are bucketed on a grid of
+ * ranks and the greedy runs on the buckets, see coarse_greedy(), which
+ * takes O(g^2) memory and time per evaluation of a g x g grid instead of
+ * anything in n. Then the cells of the committed boundaries holding several
+ * points are solved one by one by the solver, each with only its own points
+ * and candidates. The fine lines of the cells solved before that cross a
+ * cell are committed first in it, so cells of a column share vertical lines
+ * and cells of a row share horizontal ones.
+ * @param inst - the instance, read successfully
+ * @param sol - receives the lines
+ * @return 1 if the instance was solved, 0 if it is too small for a grid
+ */
+int solve_coarse(const myinstance *inst, mysolution *sol) {
+    const unsigned int n = inst->num_points;
+    unsigned int grid = coarse_grid;
+    if (grid == 0) {
+        /// about 16 points per bucket
+        for (grid = 1; (unsigned long long)(grid + 1) * (grid + 1) * 16 <= n; grid++) {
+        }
+    }
+    mycoarse c;
+    struct timespec start;
+    unsigned int i = 0;
+    int a = 0;
+    if (grid < 2 || n < 4) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int *y_sorted_copy = grow_array(NULL, sizeof (int) * n);
+    memcpy(y_sorted_copy, inst->y, sizeof (int) * n);
+    qsort(y_sorted_copy, n, sizeof (int), int_compare);
+    coarse_buckets(&c, V, inst->x, inst->x, n, grid);
+    coarse_buckets(&c, H, y_sorted_copy, inst->y, n, grid);
+    free(y_sorted_copy);
+
+    const unsigned int stride = c.buckets[H] + 1;
+    c.prefix = grow_array(NULL, sizeof (unsigned int) * (c.buckets[V] + 1) * stride);
+    memset(c.prefix, 0, sizeof (unsigned int) * (c.buckets[V] + 1) * stride);
+    for (i = 0; i < n; i++) {
+        c.prefix[(c.bucket[V][i] + 1) * stride + c.bucket[H][i] + 1]++;
+    }
+    for (i = 1; i <= c.buckets[V]; i++) {
+        unsigned int j = 1;
+        for (; j <= c.buckets[H]; j++) {
+            c.prefix[i * stride + j] += c.prefix[(i - 1) * stride + j] + c.prefix[i * stride + j - 1]
+                                        - c.prefix[(i - 1) * stride + j - 1];
+        }
+    }
+    unsigned int num_coarse = coarse_greedy(&c);
+    restore();
+
+    /// the committed boundaries are lines; every point gets the cell of its slabs
+    unsigned int *slab_of[2];
+    sol->num_lines = 0;
+    sol->job = inst->job;
+    for (a = 0; a < 2; a++) {
+        unsigned int s = 0;
+        unsigned int b = 0;
+        slab_of[a] = grow_array(NULL, sizeof (unsigned int) * c.buckets[a]);
+        for (; b < c.buckets[a]; b++) {
+            if (s + 1 < c.num_slabs[a] && c.starts[a][s + 1] == b) {
+                s++;
+                add_solution_line(sol, a, (float)c.bounds[a][b - 1]);
+            }
+            slab_of[a][b] = s;
+        }
+    }
+    uint64_t *keys = grow_array(NULL, sizeof (uint64_t) * n);
+    for (i = 0; i < n; i++) {
+        uint64_t cell = (uint64_t)slab_of[V][c.bucket[V][i]] * c.num_slabs[H] + slab_of[H][c.bucket[H][i]];
+        keys[i] = cell << 32 | i;
+    }
+    /// points of a cell stay in id order, which is x order
+    qsort(keys, n, sizeof (uint64_t), uint64_compare);
+    long coarse_ms = elapsed_ms(&start);
+
+    double *fine[2] = {NULL, NULL};
+    unsigned int num_fine[2] = {0, 0};
+    unsigned int fine_capacity[2] = {0, 0};
+    int *cx = NULL;
+    int *cy = NULL;
+    myline *presets = NULL;
+    unsigned int presets_capacity = 0;
+    unsigned int num_cells = 0;
+    unsigned int largest = 0;
+    unsigned int from = 0;
+    while (from < n) {
+        unsigned int to = from + 1;
+        while (to < n && keys[to] >> 32 == keys[from] >> 32) {
+            to++;
+        }
+        unsigned int m = to - from;
+        if (m > 1) {
+            int lo[2] = {INT_MAX, INT_MAX};
+            int hi[2] = {INT_MIN, INT_MIN};
+            unsigned int p = 0;
+            if (m > largest) {
+                largest = m;
+            }
+            cx = grow_array(cx, sizeof (int) * m);
+            cy = grow_array(cy, sizeof (int) * m);
+            for (i = 0; i < m; i++) {
+                unsigned int id = (unsigned int)keys[from + i];
+                cx[i] = inst->x[id];
+                cy[i] = inst->y[id];
+                lo[V] = cx[i] < lo[V] ? cx[i] : lo[V];
+                hi[V] = cx[i] > hi[V] ? cx[i] : hi[V];
+                lo[H] = cy[i] < lo[H] ? cy[i] : lo[H];
+                hi[H] = cy[i] > hi[H] ? cy[i] : hi[H];
+            }
+            /// the fine lines with coordinates in [lo, hi) split the points of this cell
+            for (a = 0; a < 2; a++) {
+                unsigned int first = slab_index(fine[a], num_fine[a], lo[a]);
+                unsigned int last = slab_index(fine[a], num_fine[a], hi[a]);
+                if (p + last - first > presets_capacity) {
+                    presets_capacity = 2 * (p + last - first);
+                    presets = grow_array(presets, sizeof (myline) * presets_capacity);
+                }
+                for (; first < last; first++) {
+                    presets[p].axis = a;
+                    presets[p].coord = (float)fine[a][first];
+                    p++;
+                }
+            }
+            preset_lines = presets;
+            num_presets = p;
+            load_points(m, cx, cy);
+            solve();
+            for (i = presets_committed; i < num_lines; i++) {
+                a = final_lines[i]->axis;
+                add_solution_line(sol, a, final_lines[i]->coord);
+                insert_coord(&fine[a], &num_fine[a], &fine_capacity[a], final_lines[i]->coord);
+            }
+            restore();
+            num_presets = 0;
+            preset_lines = NULL;
+            num_cells++;
+        }
+        from = to;
+    }
+    unsigned int num_lines_found = sol->num_lines;
+    if (prune) {
+        unsigned int pruned = prune_solution(inst, sol);
+        num_pruned += pruned;
+    }
+    long ms = elapsed_ms(&start);
+    printf("%s: %u coarse lines on a %ux%u grid in %ld ms, then %u fine lines in %u cells of up to %u points: "
+           "%u lines in %ld ms.\n", inst->job->name, num_coarse, c.buckets[V], c.buckets[H], coarse_ms,
+           num_lines_found - num_coarse, num_cells, largest, sol->num_lines, ms);
+
+    if (coarse_compare) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        load_instance(inst);
+        solve();
+        unsigned int flat = num_lines;
+        restore();
+        long flat_ms = elapsed_ms(&start);
+        printf("%s: the flat greedy has %u lines in %ld ms; two levels use %+d lines (%+.1f%%) in %.2fx the time.\n",
+               inst->job->name, flat, flat_ms, (int)sol->num_lines - (int)flat,
+               100.0 * ((double)sol->num_lines - flat) / (flat > 0 ? flat : 1),
+               flat_ms > 0 ? (double)ms / flat_ms : 0.0);
+    }
+
+    for (a = 0; a < 2; a++) {
+        free(slab_of[a]);
+        free(fine[a]);
+    }
+    free(keys);
+    free(cx);
+    free(cy);
+    free(presets);
+    coarse_free(&c);
+    return 1;
+}
+
+/**
+ * Returns the axis of candidate k of an instance of n points, which lists
+ * the vertical candidates first.
+ */
+static inline int beam_axis(unsigned int n, int k) {
+    return (unsigned int)k < n - 1 ? V : H;
+}
+
+/**
+ * Computes the gain of a split after every rank of both axes from the cells
+ * of a state, in O(n): sweeping the points of an axis by rank, moving a point
+ * of a cell of s points with l of them already passed adds s - 2l - 1 pairs
+ * across the split.
+ */
+void beam_gains(const mybeam *b, mybeamscratch *sc, const int *cell, const unsigned int *size) {
+    int a = 0;
+    for (; a < 2; a++) {
+        long long gain = 0;
+        unsigned int r = 0;
+        memset(sc->left, 0, sizeof (unsigned int) * b->n);
+        for (; r + 1 < b->n; r++) {
+            const int c = cell[b->order[a][r]];
+            gain += (long long)size[c] - 2 * (long long)sc->left[c] - 1;
+            sc->left[c]++;
+            sc->gain[a][r] = gain;
+        }
+    }
+}
+
+/**
+ * Returns the gain of candidate k from beam_gains().
+ */
+static inline long long beam_gain(const mybeam *b, const mybeamscratch *sc, int k) {
+    const int r = b->split[k];
+    return r < 0 ? 0 : sc->gain[beam_axis(b->n, k)][r];
+}
+
+/**
+ * Commits candidate k to the cells of a state, in O(n): the points beyond
+ * the line in cells it crosses move to new cells.
+ */
+void beam_split(const mybeam *b, mybeamscratch *sc, int *cell, unsigned int *size,
+                unsigned int *num_cells, int k) {
+    const int a = beam_axis(b->n, k);
+    const unsigned int r = (unsigned int)b->split[k];
+    unsigned int i = 0;
+    memset(sc->left, 0, sizeof (unsigned int) * b->n);
+    memset(sc->new_cell, -1, sizeof (int) * b->n);
+    for (; i <= r; i++) {
+        sc->left[cell[b->order[a][i]]]++;
+    }
+    for (; i < b->n; i++) {
+        const int p = b->order[a][i];
+        const int c = cell[p];
+        if (sc->left[c] > 0) {
+            if (sc->new_cell[c] < 0) {
+                sc->new_cell[c] = (int)(*num_cells)++;
+                size[sc->new_cell[c]] = 0;
+            }
+            cell[p] = sc->new_cell[c];
+            size[c]--;
+            size[sc->new_cell[c]]++;
+        }
+    }
+}
+
+/**
+ * Expands state i of the beam on a pool thread: its width best lines become
+ * its children, each scored by the greedy continuing from it on a copy of
+ * the cells for depth - 1 more lines, or until all points are separated if
+ * depth is 0.
+ */
+void beam_expand(void *arg, unsigned int i, int worker) {
+    mybeam *b = arg;
+    const mybeamstate *st = &b->states[i];
+    mybeamscratch *sc = &b->scratch[worker];
+    mybeamchild *children = &b->children[i * b->width];
+    unsigned int filled = 0;
+    unsigned int j = 0;
+    int k = 0;
+    for (; j < b->width; j++) {
+        children[j].parent = i;
+        children[j].line = -1;
+    }
+    beam_gains(b, sc, st->cell, st->size);
+    /// keeps the width best candidates sorted by gain, the first one on ties
+    for (; k < (int)b->num_candidates; k++) {
+        const long long gain = beam_gain(b, sc, k);
+        if (gain <= 0 || (filled == b->width && st->pairs - gain >= children[filled - 1].after)) {
+            continue;
+        }
+        j = filled < b->width ? filled++ : filled - 1;
+        for (; j > 0 && children[j - 1].after > st->pairs - gain; j--) {
+            children[j] = children[j - 1];
+        }
+        children[j].parent = i;
+        children[j].line = k;
+        children[j].after = st->pairs - gain;
+    }
+
+    for (j = 0; j < filled; j++) {
+        mybeamchild *child = &children[j];
+        unsigned int num_cells = st->num_cells;
+        memcpy(sc->cell, st->cell, sizeof (int) * b->n);
+        memcpy(sc->size, st->size, sizeof (unsigned int) * num_cells);
+        beam_split(b, sc, sc->cell, sc->size, &num_cells, child->line);
+        child->steps = 1;
+        child->pairs = child->after;
+        while ((b->depth == 0 || child->steps < b->depth) && child->pairs > 0) {
+            long long best_gain = 0;
+            int best = -1;
+            beam_gains(b, sc, sc->cell, sc->size);
+            for (k = 0; k < (int)b->num_candidates; k++) {
+                const long long gain = beam_gain(b, sc, k);
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best = k;
+                }
+            }
+            if (best < 0) {
+                /// the pairs left share both coordinates and no line separates them
+                break;
+            }
+            beam_split(b, sc, sc->cell, sc->size, &num_cells, best);
+            child->pairs -= (unsigned long long)best_gain;
+            child->steps++;
+        }
+    }
+}
+
+/**
+ * Copies kept child i out of its parent into the next beam on a pool thread.
+ */
+void beam_materialize(void *arg, unsigned int i, int worker) {
+    mybeam *b = arg;
+    const mybeamchild *child = &b->kept[i];
+    const mybeamstate *parent = &b->states[child->parent];
+    mybeamstate *st = &b->next[i];
+    memcpy(st->cell, parent->cell, sizeof (int) * b->n);
+    memcpy(st->size, parent->size, sizeof (unsigned int) * parent->num_cells);
+    st->num_cells = parent->num_cells;
+    beam_split(b, &b->scratch[worker], st->cell, st->size, &st->num_cells, child->line);
+    st->pairs = child->after;
+}
+
+/**
+ * Orders children by how few lines their lookahead took, then the pairs
+ * left after it, then the pairs left after their own line, then by parent
+ * and line; children without a line come last.
+ */
+int beam_child_compare(const void *a, const void *b) {
+    const mybeamchild *ca = a;
+    const mybeamchild *cb = b;
+    if ((ca->line < 0) != (cb->line < 0)) {
+        return ca->line < 0 ? 1 : -1;
+    }
+    if (ca->line < 0) {
+        return 0;
+    }
+    if (ca->steps != cb->steps) {
+        return ca->steps < cb->steps ? -1 : 1;
+    }
+    if (ca->pairs != cb->pairs) {
+        return ca->pairs < cb->pairs ? -1 : 1;
+    }
+    if (ca->after != cb->after) {
+        return ca->after < cb->after ? -1 : 1;
+    }
+    if (ca->parent != cb->parent) {
+        return ca->parent < cb->parent ? -1 : 1;
+    }
+    return (ca->line > cb->line) - (ca->line < cb->line);
+}
+
+/**
+ * Runs task over count items on the restart pool, or on this thread as
+ * worker 0 without one.
+ */
+void beam_run(void (*task)(void *, unsigned int, int), mybeam *b, unsigned int count) {
+    unsigned int i = 0;
+    if (restart_pool != NULL) {
+        pool_run(restart_pool, task, b, count);
+        return;
+    }
+    for (; i < count; i++) {
+        task(b, i, 0);
+    }
+}
+
+/**
+ * Solves an instance by a beam search over sequences of lines. The beam
+ * keeps beam_width states; every state offers its beam_width best lines as
+ * children, scored by the lines the greedy continuing from each took and
+ * the pairs it left, and the best children holding distinct sets of lines
+ * become the next beam. Gains of all candidates of a state take one O(n)
+ * sweep per axis over its cells, and a child only gets cells of its own,
+ * copied from its parent, once it is kept. The states are expanded on the
+ * restart pool. A width and depth of 1 give the greedy. With depth 0 the
+ * greedy continues until all points are separated, and as the best line of
+ * a state is always among its children, the best state never needs more
+ * lines than the greedy from the state before it: the search ends with at
+ * most the lines of the greedy.
+ * @param inst - the instance, read successfully
+ * @param sol - receives the lines
+ * @return 1 if the instance was solved, 0 if it has fewer than two points
+ */
+int solve_beam(const myinstance *inst, mysolution *sol) {
+    const unsigned int n = inst->num_points;
+    const int threads = restart_pool != NULL ? restart_pool->num_threads : 1;
+    struct timespec start;
+    mybeam b;
+    unsigned int i = 0;
+    unsigned int rounds = 0;
+    int t = 0;
+    if (n < 2) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    load_instance(inst);
+    rank_points();
+    pre_separate();
+    line_split = arena_alloc(sizeof (int) * num_all_lines);
+    line_splits(line_split);
+
+    b.n = n;
+    b.num_candidates = num_all_lines;
+    b.order[V] = x_order;
+    b.order[H] = y_order;
+    b.split = line_split;
+    b.width = beam_width;
+    b.depth = beam_depth;
+    b.states = arena_alloc(sizeof (mybeamstate) * b.width);
+    b.next = arena_alloc(sizeof (mybeamstate) * b.width);
+    for (; i < b.width; i++) {
+        b.states[i].cell = arena_alloc(sizeof (int) * n);
+        b.states[i].size = arena_alloc(sizeof (unsigned int) * n);
+        b.next[i].cell = arena_alloc(sizeof (int) * n);
+        b.next[i].size = arena_alloc(sizeof (unsigned int) * n);
+    }
+    b.children = arena_alloc(sizeof (mybeamchild) * b.width * b.width);
+    b.kept = arena_alloc(sizeof (mybeamchild) * b.width);
+    b.scratch = arena_alloc(sizeof (mybeamscratch) * threads);
+    for (; t < threads; t++) {
+        mybeamscratch *sc = &b.scratch[t];
+        sc->cell = arena_alloc(sizeof (int) * n);
+        sc->size = arena_alloc(sizeof (unsigned int) * n);
+        sc->left = arena_alloc(sizeof (unsigned int) * n);
+        sc->new_cell = arena_alloc(sizeof (int) * n);
+        sc->gain[V] = arena_alloc(sizeof (long long) * n);
+        sc->gain[H] = arena_alloc(sizeof (long long) * n);
+    }
+    b.nodes = NULL;
+    b.num_nodes = 0;
+    b.nodes_capacity = 0;
+
+    mybeamstate *root = &b.states[0];
+    memset(root->cell, 0, sizeof (int) * n);
+    root->size[0] = n;
+    root->num_cells = 1;
+    root->pairs = (unsigned long long)n * (n - 1) / 2;
+    root->node = -1;
+    root->hash = 0;
+    b.num_states = 1;
+
+    /// the first state of the beam is the best one, and it ends the search once it separates all
+    while (b.states[0].pairs > 0) {
+        beam_run(beam_expand, &b, b.num_states);
+        qsort(b.children, b.num_states * b.width, sizeof (mybeamchild), beam_child_compare);
+        b.num_kept = 0;
+        for (i = 0; i < b.num_states * b.width && b.num_kept < b.width; i++) {
+            const mybeamchild *child = &b.children[i];
+            if (child->line < 0) {
+                break;
+            }
+            uint64_t line_hash = (uint64_t)child->line;
+            uint64_t hash = b.states[child->parent].hash ^ next_random(&line_hash);
+            unsigned int j = 0;
+            while (j < b.num_kept && b.next[j].hash != hash) {
+                j++;
+            }
+            if (j < b.num_kept) {
+                continue;
+            }
+            if (b.num_nodes == b.nodes_capacity) {
+                b.nodes_capacity = b.nodes_capacity == 0 ? 1024 : 2 * b.nodes_capacity;
+                b.nodes = grow_array(b.nodes, sizeof (mybeamnode) * b.nodes_capacity);
+            }
+            b.nodes[b.num_nodes].parent = b.states[child->parent].node;
+            b.nodes[b.num_nodes].line = child->line;
+            b.next[b.num_kept].node = (int)b.num_nodes++;
+            b.next[b.num_kept].hash = hash;
+            b.kept[b.num_kept++] = *child;
+        }
+        if (b.num_kept == 0) {
+            /// points sharing both coordinates cannot be separated
+            break;
+        }
+        beam_run(beam_materialize, &b, b.num_kept);
+        mybeamstate *swap = b.states;
+        b.states = b.next;
+        b.next = swap;
+        b.num_states = b.num_kept;
+        rounds++;
+    }
+
+    /// the lines of the best state, from its last node back to the first
+    int node = b.states[0].node;
+    sol->job = inst->job;
+    sol->num_lines = rounds;
+    if (sol->capacity < rounds) {
+        sol->capacity = rounds;
+        sol->lines = grow_array(sol->lines, sizeof (myline) * rounds);
+    }
+    for (i = rounds; i > 0; i--) {
+        sol->lines[i - 1] = all_lines[b.nodes[node].line];
+        node = b.nodes[node].parent;
+    }
+    free(b.nodes);
+    restore();
+    unsigned int num_lines_found = sol->num_lines;
+    if (prune) {
+        num_pruned += prune_solution(inst, sol);
+    }
+    if (!report_solves) {
+        return 1;
+    }
+    if (beam_depth > 0) {
+        printf("%s: beam of %u states looking %u lines ahead: ", inst->job->name, beam_width, beam_depth);
+    } else {
+        printf("%s: beam of %u states looking ahead to the end: ", inst->job->name, beam_width);
+    }
+    printf("%u lines (%u before pruning) in %ld ms on %d threads.\n",
+           sol->num_lines, num_lines_found, elapsed_ms(&start), threads);
+    return 1;
+}
+
+/**
+ * Returns the fewest lines that can cross one cell of m points so that they
+ * end up in distinct cells, if the most points sharing an x-coordinate are
+ * mx and the most sharing a y-coordinate are my: a vertical and b horizontal
+ * lines make at most (a+1)(b+1) cells, points sharing an x-coordinate need
+ * b >= mx - 1 and points sharing a y-coordinate need a >= my - 1.
+ */
+unsigned int counting_bound(unsigned int m, unsigned int mx, unsigned int my) {
+    unsigned int best = m - 1;
+    unsigned int a = my > 0 ? my - 1 : 0;
+    for (; a < m; a++) {
+        unsigned int b = (m + a) / (a + 1) - 1;
+        if (b < mx - 1) {
+            b = mx - 1;
+        }
+        if (a + b < best) {
+            best = a + b;
+        }
+        if (a >= best) {
+            break;
+        }
+    }
+    return best;
+}
+
+/**
+ * Returns the axis of candidate line k and its rank r: the line lies between
+ * the points of rank r and r + 1 on that axis.
+ */
+static inline int candidate_axis(unsigned int n, int k, int *r) {
+    if (k < (int)n - 1) {
+        *r = k;
+        return V;
+    }
+    *r = k - (int)(n - 1);
+    return H;
+}
+
+void deque_push(myexactdeque *d, myexactnode *node) {
+    pthread_mutex_lock(&d->lock);
+    if (d->tail == d->capacity) {
+        if (d->head > 0) {
+            memmove(d->nodes, d->nodes + d->head, sizeof (myexactnode *) * (d->tail - d->head));
+            d->tail -= d->head;
+            d->head = 0;
+        } else {
+            d->capacity = d->capacity == 0 ? 256 : d->capacity * 2;
+            d->nodes = realloc(d->nodes, sizeof (myexactnode *) * d->capacity);
+            if (d->nodes == NULL) {
+                printf("Out of memory\n");
+                exit(1);
+            }
+        }
+    }
+    d->nodes[d->tail++] = node;
+    pthread_mutex_unlock(&d->lock);
+}
+
+/**
+ * The owner of a deque pops its newest node, so that it searches depth first.
+ */
+myexactnode *deque_pop(myexactdeque *d) {
+    myexactnode *node = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) {
+        node = d->nodes[--d->tail];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return node;
+}
+
+/**
+ * Other threads steal the oldest node, which roots the largest subtree.
+ */
+myexactnode *deque_steal(myexactdeque *d) {
+    myexactnode *node = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) {
+        node = d->nodes[d->head++];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return node;
+}
+
+/**
+ * Computes the cells of the points below a node of the exact search.
+ * Every point is labelled with the smallest id in its cell, so that equal
+ * partitions get equal labels, and size[label] counts the cell.
+ * @return the hash of the partition
+ */
+uint64_t exact_labels(const myexact *e, const myexactnode *node, myexactscratch *s) {
+    const unsigned int n = e->n;
+    unsigned int i = 0;
+    int a = 0;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (a = 0; a < 2; a++) {
+        memset(s->cut[a], 0, n + 1);
+    }
+    s->lines[V] = s->lines[H] = 0;
+    for (i = 0; i < node->depth; i++) {
+        int r;
+        a = candidate_axis(n, node->lines[i], &r);
+        s->cut[a][r + 1] = 1;
+        s->lines[a]++;
+    }
+    for (a = 0; a < 2; a++) {
+        int slab = 0;
+        for (i = 0; i < n; i++) {
+            slab += s->cut[a][i];
+            s->slab[a][e->order[a][i]] = slab;
+        }
+    }
+    cellset_clear(&s->cells, n);
+    memset(s->size, 0, sizeof (int) * n);
+    for (i = 0; i < n; i++) {
+        int other = cellset_insert(&s->cells, cell_key((unsigned int)s->slab[V][i], (unsigned int)s->slab[H][i]), (int)i);
+        s->label[i] = other >= 0 ? other : (int)i;
+        s->size[s->label[i]]++;
+        hash = (hash ^ (uint64_t)s->label[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+int pair_compare(const void *a, const void *b) {
+    const myexactpair *pa = a;
+    const myexactpair *pb = b;
+    return (pa->cost > pb->cost) - (pa->cost < pb->cost);
+}
+
+/**
+ * Lists the pairs of points of a cell that are next to each other in the
+ * order of an axis, with the ranges of candidate lines separating them,
+ * cheapest first.
+ * @return the number of pairs
+ */
+unsigned int exact_pairs(const myexact *e, myexactscratch *s) {
+    const unsigned int n = e->n;
+    unsigned int num = 0;
+    int a = 0;
+    for (; a < 2; a++) {
+        unsigned int r = 0;
+        memset(s->last, -1, sizeof (int) * n);
+        for (; r < n; r++) {
+            int id = e->order[a][r];
+            int cell = s->label[id];
+            if (s->last[cell] >= 0) {
+                myexactpair *p = &s->pairs[num++];
+                int other = s->last[cell];
+                int b = 0;
+                p->p = other;
+                p->q = id;
+                p->cost = 0;
+                for (; b < 2; b++) {
+                    int lo = e->rank[b][other];
+                    int hi = e->rank[b][id];
+                    p->lo[b] = lo < hi ? lo : hi;
+                    p->hi[b] = lo < hi ? hi : lo;
+                    p->cost += e->gaps[b][p->hi[b]] - e->gaps[b][p->lo[b]];
+                }
+            }
+            s->last[cell] = id;
+        }
+    }
+    qsort(s->pairs, num, sizeof (myexactpair), pair_compare);
+    return num;
+}
+
+/**
+ * A lower bound on the lines still needed below a node with lines[V]
+ * vertical and lines[H] horizontal lines: the largest of the counting bound
+ * of all points, the counting bound of the most demanding cell and the number
+ * of pairs whose ranges of separating lines are disjoint, found greedily
+ * cheapest first. It stops counting pairs once need is reached.
+ */
+unsigned int exact_lower_bound(const myexact *e, myexactscratch *s, const unsigned int *lines,
+                               unsigned int num_pairs, unsigned int need) {
+    const unsigned int n = e->n;
+    unsigned int bound = n;
+    unsigned int i = 0;
+    int a = 0;
+
+    /// (A+1)(B+1) >= n with at least the lines already there on each axis
+    for (i = lines[V]; i < n && i - lines[V] < bound; i++) {
+        unsigned int b = (n + i) / (i + 1) - 1;
+        if (b < lines[H]) {
+            b = lines[H];
+        }
+        if (i + b - lines[V] - lines[H] < bound) {
+            bound = i + b - lines[V] - lines[H];
+        }
+    }
+
+    /// the most points of a cell sharing a coordinate, per axis
+    for (a = 0; a < 2; a++) {
+        unsigned int r = 0;
+        memset(s->mult[a], 0, sizeof (int) * n);
+        while (r < n) {
+            unsigned int end = r + 1;
+            const int *sorted = a == V ? e->x_sorted : e->y_sorted;
+            while (end < n && (float)sorted[end] == (float)sorted[r]) {
+                end++;
+            }
+            for (i = r; i < end; i++) {
+                int cell = s->label[e->order[a][i]];
+                if (++s->run[cell] > s->mult[a][cell]) {
+                    s->mult[a][cell] = s->run[cell];
+                }
+            }
+            for (i = r; i < end; i++) {
+                s->run[s->label[e->order[a][i]]] = 0;
+            }
+            r = end;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (s->label[i] == (int)i && s->size[i] > 1) {
+            unsigned int b = counting_bound(s->size[i], s->mult[V][i], s->mult[H][i]);
+            if (b > bound) {
+                bound = b;
+            }
+        }
+    }
+
+    unsigned int disjoint = 0;
+    for (i = 0; i < num_pairs && disjoint < need; i++) {
+        const myexactpair *p = &s->pairs[i];
+        unsigned int j = 0;
+        for (; j < disjoint; j++) {
+            const myexactpair *q = s->chosen[j];
+            if ((p->lo[V] < q->hi[V] && q->lo[V] < p->hi[V]) || (p->lo[H] < q->hi[H] && q->lo[H] < p->hi[H])) {
+                break;
+            }
+        }
+        if (j == disjoint) {
+            s->chosen[disjoint++] = p;
+        }
+    }
+    return disjoint > bound ? disjoint : bound;
+}
+
+/**
+ * Looks a partition up in the memo and records it.
+ * @return 1 if the partition was reached before with at most depth lines
+ */
+int exact_memo(myexact *e, uint64_t hash, unsigned int depth) {
+    size_t slot = cell_hash(hash) & e->memo_mask;
+    unsigned int probe = 0;
+    int seen = 0;
+    pthread_mutex_lock(&e->memo_lock);
+    for (; probe < 32; probe++, slot = (slot + 1) & e->memo_mask) {
+        if (e->memo_keys[slot] == 0) {
+            e->memo_keys[slot] = hash | 1;
+            e->memo_depth[slot] = depth;
+            break;
+        }
+        if (e->memo_keys[slot] == (hash | 1)) {
+            seen = e->memo_depth[slot] <= depth;
+            if (!seen) {
+                e->memo_depth[slot] = depth;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&e->memo_lock);
+    return seen;
+}
+
+/**
+ * Wakes the idle threads of the exact search, after nodes were pushed or
+ * the last node was visited.
+ */
+void exact_wake(myexact *e) {
+    pthread_mutex_lock(&e->idle_lock);
+    if (e->num_idle > 0) {
+        pthread_cond_broadcast(&e->idle);
+    }
+    pthread_mutex_unlock(&e->idle_lock);
+}
+
+int child_compare(const void *a, const void *b) {
+    const myexactchild *ca = a;
+    const myexactchild *cb = b;
+    if (ca->gain != cb->gain) {
+        return ca->gain < cb->gain ? 1 : -1;
+    }
+    return ca->line - cb->line;
+}
+
+/**
+ * Visits a node of the exact search: records it if its lines separate all
+ * points, drops it if it cannot beat the best solution, and otherwise
+ * branches on the lines separating the cheapest pair of points left in a
+ * cell. Lines giving the same partition are symmetric and only one is
+ * branched on; children are pushed so that the one breaking the most links
+ * is visited first.
+ */
+void exact_visit(myexactworker *w, const myexactnode *node, myexactscratch *s) {
+    myexact *e = w->e;
+    const unsigned int n = e->n;
+    uint64_t hash = exact_labels(e, node, s);
+    unsigned int best = __atomic_load_n(&e->best_count, __ATOMIC_ACQUIRE);
+    unsigned int i = 0;
+
+    w->nodes++;
+    for (; i < n && s->size[s->label[i]] == 1; i++) {
+    }
+    if (i == n) {
+        pthread_mutex_lock(&e->lock);
+        if (node->depth < e->best_count) {
+            memcpy(e->best_lines, node->lines, sizeof (int) * node->depth);
+            __atomic_store_n(&e->best_count, node->depth, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&e->lock);
+        return;
+    }
+    if (node->depth + 1 >= best || exact_memo(e, hash, node->depth)) {
+        return;
+    }
+    unsigned int num_pairs = exact_pairs(e, s);
+    if (node->depth + exact_lower_bound(e, s, s->lines, num_pairs, best - node->depth) >= best) {
+        return;
+    }
+
+    const myexactpair *pair = &s->pairs[0];
+    unsigned int num_children = 0;
+    int a = 0;
+    for (; a < 2; a++) {
+        int r = pair->lo[a];
+        for (; r < pair->hi[a]; r++) {
+            int k = a == V ? r : (int)(n - 1) + r;
+            if (!e->valid[k]) {
+                continue;
+            }
+            /// the partition after line k and the pairs it separates
+            uint64_t child_hash = 0xcbf29ce484222325ULL;
+            long long gain = 0;
+            unsigned int c = 0;
+            for (i = 0; i < n; i++) {
+                int side = e->rank[a][i] > r;
+                int cell = s->label[i];
+                if (s->first[side][cell] < 0) {
+                    s->first[side][cell] = (int)i;
+                }
+                s->count[side][cell]++;
+                child_hash = (child_hash ^ (uint64_t)s->first[side][cell]) * 0x100000001b3ULL;
+            }
+            for (i = 0; i < n; i++) {
+                int cell = s->label[i];
+                if (cell == (int)i) {
+                    gain += (long long)s->count[0][cell] * s->count[1][cell];
+                }
+            }
+            for (i = 0; i < n; i++) {
+                int cell = s->label[i];
+                s->first[0][cell] = s->first[1][cell] = -1;
+                s->count[0][cell] = s->count[1][cell] = 0;
+            }
+            for (; c < num_children && s->children[c].hash != child_hash; c++) {
+            }
+            if (c == num_children) {
+                s->children[num_children].hash = child_hash;
+                s->children[num_children].gain = gain;
+                s->children[num_children].line = k;
+                num_children++;
+            }
+        }
+    }
+    qsort(s->children, num_children, sizeof (myexactchild), child_compare);
+
+    __atomic_add_fetch(&e->pending, (long)num_children, __ATOMIC_ACQ_REL);
+    for (i = num_children; i > 0; i--) {
+        myexactnode *child = malloc(sizeof (myexactnode) + sizeof (int) * (node->depth + 1));
+        if (child == NULL) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        child->depth = node->depth + 1;
+        memcpy(child->lines, node->lines, sizeof (int) * node->depth);
+        child->lines[node->depth] = s->children[i - 1].line;
+        deque_push(&e->deques[w->id], child);
+    }
+    if (num_children > 0) {
+        __atomic_add_fetch(&e->queued, (long)num_children, __ATOMIC_ACQ_REL);
+        exact_wake(e);
+    }
+}
+
+/**
+ * A thread of the exact search: visits the nodes of its own deque depth
+ * first and steals from the others when it runs dry, and waits when no
+ * deque has a node, until no node is left.
+ */
+void *exact_worker(void *arg) {
+    myexactworker *w = arg;
+    myexact *e = w->e;
+    const unsigned int n = e->n;
+    myexactscratch s;
+    int a = 0;
+
+    s.label = arena_alloc(sizeof (int) * n);
+    s.size = arena_alloc(sizeof (int) * n);
+    s.last = arena_alloc(sizeof (int) * n);
+    s.run = arena_alloc(sizeof (int) * n);
+    s.pairs = arena_alloc(sizeof (myexactpair) * 2 * n);
+    s.chosen = arena_alloc(sizeof (myexactpair *) * 2 * n);
+    s.children = arena_alloc(sizeof (myexactchild) * 2 * n);
+    for (; a < 2; a++) {
+        s.cut[a] = arena_alloc(n + 1);
+        s.slab[a] = arena_alloc(sizeof (int) * n);
+        s.mult[a] = arena_alloc(sizeof (int) * n);
+        s.first[a] = arena_alloc(sizeof (int) * n);
+        s.count[a] = arena_alloc(sizeof (int) * n);
+        memset(s.first[a], -1, sizeof (int) * n);
+        memset(s.count[a], 0, sizeof (int) * n);
+    }
+    memset(s.run, 0, sizeof (int) * n);
+    cellset_init(&s.cells, n);
+
+    for (;;) {
+        myexactnode *node = deque_pop(&e->deques[w->id]);
+        int i = 1;
+        for (; node == NULL && i < e->num_threads; i++) {
+            node = deque_steal(&e->deques[(w->id + i) % e->num_threads]);
+        }
+        if (node == NULL) {
+            pthread_mutex_lock(&e->idle_lock);
+            e->num_idle++;
+            while (__atomic_load_n(&e->queued, __ATOMIC_ACQUIRE) <= 0
+                   && __atomic_load_n(&e->pending, __ATOMIC_ACQUIRE) > 0) {
+                pthread_cond_wait(&e->idle, &e->idle_lock);
+            }
+            e->num_idle--;
+            pthread_mutex_unlock(&e->idle_lock);
+            if (__atomic_load_n(&e->pending, __ATOMIC_ACQUIRE) == 0) {
+                break;
+            }
+            continue;
+        }
+        __atomic_sub_fetch(&e->queued, 1, __ATOMIC_ACQ_REL);
+        if (budget_ms > 0 && !__atomic_load_n(&e->stopped, __ATOMIC_RELAXED)
+            && elapsed_ms(&e->start) >= budget_ms) {
+            __atomic_store_n(&e->stopped, 1, __ATOMIC_RELAXED);
+        }
+        if (!__atomic_load_n(&e->stopped, __ATOMIC_RELAXED)) {
+            exact_visit(w, node, &s);
+        }
+        free(node);
+        if (__atomic_sub_fetch(&e->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+            exact_wake(e);
+        }
+    }
+    arena_free();
+    return NULL;
+}
+
+/**
+ * Searches the candidate lines of the solved instance for a smallest set
+ * separating all points, starting from the greedy solution as the best
+ * known, and replaces the committed lines with it.
+ * Nodes are sets of committed lines; partitions already reached with as few
+ * lines are not searched again. With --budget-ms the search stops when the
+ * budget is spent and keeps the best solution found.
+ * @param nodes - receives the number of visited nodes
+ * @return 1 if the solution is proven optimal
+ */
+int exact_search(unsigned long long *nodes) {
+    const unsigned int n = num_points;
+    myexact e;
+    unsigned int i = 0;
+    int a = 0;
+    int t = 0;
+    int r = 0;
+
+    e.n = n;
+    e.rank[V] = x_rank;
+    e.rank[H] = y_rank;
+    e.order[V] = x_order;
+    e.order[H] = y_order;
+    e.x_sorted = x_sorted;
+    e.y_sorted = y_sorted;
+    e.num_threads = num_threads;
+    e.pending = 1;
+    e.queued = 1;
+    e.num_idle = 0;
+    e.stopped = 0;
+    e.best_count = num_lines;
+    e.best_lines = malloc(sizeof (int) * (num_lines + 1));
+    e.memo_mask = EXACT_MEMO_SIZE - 1;
+    e.memo_keys = calloc(EXACT_MEMO_SIZE, sizeof (uint64_t));
+    e.memo_depth = malloc(sizeof (unsigned int) * EXACT_MEMO_SIZE);
+    e.deques = calloc(num_threads, sizeof (myexactdeque));
+    char *valid = arena_alloc(num_all_lines);
+    int *gaps[2];
+    clock_gettime(CLOCK_MONOTONIC, &e.start);
+    pthread_mutex_init(&e.lock, NULL);
+    pthread_mutex_init(&e.memo_lock, NULL);
+    pthread_mutex_init(&e.idle_lock, NULL);
+    pthread_cond_init(&e.idle, NULL);
+    for (i = 0; i < num_lines; i++) {
+        e.best_lines[i] = (int)(final_lines[i] - all_lines);
+    }
+
+    /// a candidate is only worth committing if it lies between two distinct coordinates
+    for (a = 0; a < 2; a++) {
+        const int *sorted = a == V ? x_sorted : y_sorted;
+        gaps[a] = arena_alloc(sizeof (int) * n);
+        gaps[a][0] = 0;
+        for (r = 0; r + 1 < (int)n; r++) {
+            int k = a == V ? r : (int)(n - 1) + r;
+            valid[k] = (float)sorted[r] != (float)sorted[r + 1];
+            gaps[a][r + 1] = gaps[a][r] + valid[k];
+        }
+        e.gaps[a] = gaps[a];
+    }
+    e.valid = valid;
+
+    myexactworker *workers = malloc(sizeof (myexactworker) * num_threads);
+    for (t = 0; t < num_threads; t++) {
+        pthread_mutex_init(&e.deques[t].lock, NULL);
+    }
+    deque_push(&e.deques[0], calloc(1, sizeof (myexactnode)));
+    for (t = 0; t < num_threads; t++) {
+        workers[t].e = &e;
+        workers[t].id = t;
+        workers[t].nodes = 0;
+        pthread_create(&workers[t].thread, NULL, exact_worker, &workers[t]);
+    }
+    *nodes = 0;
+    for (t = 0; t < num_threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        *nodes += workers[t].nodes;
+    }
+    /// the deques are freed once no thread can steal from them
+    for (t = 0; t < num_threads; t++) {
+        pthread_mutex_destroy(&e.deques[t].lock);
+        free(e.deques[t].nodes);
+    }
+
+    for (i = 0; i < e.best_count; i++) {
+        final_lines[i] = &all_lines[e.best_lines[i]];
+    }
+    num_lines = e.best_count;
+    pthread_mutex_destroy(&e.lock);
+    pthread_mutex_destroy(&e.memo_lock);
+    pthread_mutex_destroy(&e.idle_lock);
+    pthread_cond_destroy(&e.idle);
+    free(workers);
+    free(e.deques);
+    free(e.best_lines);
+    free(e.memo_keys);
+    free(e.memo_depth);
+    return !e.stopped;
+}
+
+int xy_compare(const void *a, const void *b) {
+    const int *pa = a;
+    const int *pb = b;
+    if (pa[0] != pb[0]) {
+        return (pa[0] > pb[0]) - (pa[0] < pb[0]);
+    }
+    return (pa[1] > pb[1]) - (pa[1] < pb[1]);
+}
+
+/**
+ * Returns the number of points of the longest chain whose coordinates never
+ * decrease, in O(n log n): every two neighbours of such a chain need a line
+ * of their own between them.
+ * @param xy - the points as (x, y) pairs, sorted by x then y
+ */
+unsigned int longest_chain(const int *xy, unsigned int n) {
+    int *tails = malloc(sizeof (int) * n);
+    unsigned int len = 0;
+    unsigned int i = 0;
+    for (; i < n; i++) {
+        /// the first chain end greater than y is replaced, or the longest chain grows
+        unsigned int lo = 0;
+        unsigned int hi = len;
+        while (lo < hi) {
+            unsigned int mid = (lo + hi) / 2;
+            if (tails[mid] <= xy[2 * i + 1]) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        tails[lo] = xy[2 * i + 1];
+        if (lo == len) {
+            len++;
+        }
+    }
+    free(tails);
+    return len;
+}
+
+/**
+ * Returns the most points sharing one coordinate of the sorted coordinates.
+ */
+unsigned int max_multiplicity(const int *sorted, unsigned int n, unsigned int stride) {
+    unsigned int most = n > 0;
+    unsigned int run = 1;
+    unsigned int i = 1;
+    for (; i < n; i++) {
+        run = sorted[i * stride] == sorted[(i - 1) * stride] ? run + 1 : 1;
+        if (run > most) {
+            most = run;
+        }
+    }
+    return most;
+}
+
+/**
+ * Returns a lower bound on the number of lines separating n distinct points,
+ * in O(n log n): the largest of
+ * - the counting bound: a vertical and b horizontal lines make at most
+ *   (a+1)(b+1) cells, with at least m-1 lines across m points sharing a
+ *   coordinate, see counting_bound();
+ * - the longest chain rising in both coordinates, minus one;
+ * - the longest chain falling in y while rising in x, minus one.
+ */
+unsigned int lower_bound(unsigned int n, const int *x, const int *y) {
+    int *xy = malloc(sizeof (int) * 2 * n);
+    int *ys = malloc(sizeof (int) * n);
+    unsigned int i = 0;
+    if (n < 2) {
+        free(xy);
+        free(ys);
+        return 0;
+    }
+    for (; i < n; i++) {
+        xy[2 * i] = x[i];
+        xy[2 * i + 1] = y[i];
+        ys[i] = y[i];
+    }
+    qsort(ys, n, sizeof (int), int_compare);
+    qsort(xy, n, 2 * sizeof (int), xy_compare);
+    unsigned int mx = max_multiplicity(xy, n, 2);
+    unsigned int my = max_multiplicity(ys, n, 1);
+    unsigned int bound = counting_bound(n, mx, my);
+
+    unsigned int chain = longest_chain(xy, n);
+    if (chain - 1 > bound) {
+        bound = chain - 1;
+    }
+    /// falling chains are rising chains of the points mirrored in y
+    for (i = 0; i < n; i++) {
+        xy[2 * i] = x[i];
+        xy[2 * i + 1] = y[i] == INT_MIN ? INT_MAX : -y[i];
+    }
+    qsort(xy, n, 2 * sizeof (int), xy_compare);
+    chain = longest_chain(xy, n);
+    if (chain - 1 > bound) {
+        bound = chain - 1;
+    }
+    free(xy);
+    free(ys);
+    return bound;
+}
+
+/**
+ * Prints the gap between a solution and the lower bound of its instance.
+ * A partial solution, which leaves points sharing cells, has no gap and is
+ * left out of the totals.
+ */
+void report_gap(const myinstance *inst, unsigned int lines, int partial) {
+    unsigned int bound = lower_bound(inst->num_points, inst->x, inst->y);
+    if (partial || lines < bound) {
+        printf("%s: %u lines, partial; at least %u needed to separate all points.\n",
+               inst->job->name, lines, bound);
+        return;
+    }
+    printf("%s: %u lines, at least %u needed, gap %u.\n", inst->job->name, lines, bound, lines - bound);
+    total_gap += lines - bound;
+    num_bounded++;
+}
+
+/**
+ * Returns the start of the slab holding a rank of an axis once the lines
+ * of the move are gone, in O(log n).
+ */
+static inline int local_slab(const mylocal *l, int axis, int rank) {
+    const int *bounds = l->bounds[axis];
+    unsigned int lo = 0;
+    unsigned int hi = l->num_bounds[axis];
+    while (hi - lo > 1) {
+        unsigned int mid = (lo + hi) / 2;
+        if (bounds[mid] <= rank) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    while (bounds[lo] == l->gone[axis][0] || bounds[lo] == l->gone[axis][1]) {
+        lo--;
+    }
+    return bounds[lo];
+}
+
+/**
+ * Puts the points of ranks [from, to) of an axis into their cells once the
+ * lines of the move are gone, skipping those with a rank of axis skip in
+ * [skip_from, skip_to), and records the pairs of points sharing a cell.
+ * @return 0 if a cell holds three points or more, else 1
+ */
+int local_place(mylocal *l, int axis, int from, int to, int skip, int skip_from, int skip_to) {
+    int r = from;
+    for (; r < to; r++) {
+        const int id = l->order[axis][r];
+        if (skip >= 0 && l->rank[skip][id] >= skip_from && l->rank[skip][id] < skip_to) {
+            continue;
+        }
+        const uint64_t key = cell_key((unsigned int)local_slab(l, V, l->rank[V][id]),
+                                      (unsigned int)local_slab(l, H, l->rank[H][id]));
+        const int other = cellset_insert(&l->cells, key, id);
+        if (other == -2) {
+            return 0;
+        }
+        if (other >= 0) {
+            /// marks the cell as holding a pair, so that a third point fails the move
+            cellset_remove(&l->cells, key);
+            cellset_insert(&l->cells, key, -2);
+            l->pairs[2 * l->num_pairs] = other;
+            l->pairs[2 * l->num_pairs + 1] = id;
+            l->num_pairs++;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Takes out line j of axis a, and line j2 of axis a2 too if a2 >= 0, and
+ * finds the pairs of points left sharing cells. Only the points of the
+ * slabs the lines closed can end up together, in O(k log n) for k of them.
+ * @return 0 if a cell holds three points or more, else 1
+ */
+int local_collide(mylocal *l, int a, unsigned int j, int a2, unsigned int j2) {
+    const int from = l->bounds[a][j - 1];
+    const int to = l->bounds[a][j + 1];
+    unsigned int count = (unsigned int)(to - from);
+    int ok;
+    l->gone[V][0] = l->gone[V][1] = l->gone[H][0] = l->gone[H][1] = -1;
+    l->gone[a][0] = l->bounds[a][j];
+    if (a2 >= 0) {
+        l->gone[a2][1] = l->bounds[a2][j2];
+        count += (unsigned int)(l->bounds[a2][j2 + 1] - l->bounds[a2][j2 - 1]);
+    }
+    l->num_pairs = 0;
+    cellset_clear(&l->cells, count < num_points ? count : num_points);
+    ok = local_place(l, a, from, to, -1, 0, 0);
+    if (ok && a2 >= 0) {
+        ok = local_place(l, a2, l->bounds[a2][j2 - 1], l->bounds[a2][j2 + 1], a, from, to);
+    }
+    return ok;
+}
+
+/**
+ * Finds a line separating every pair the move left sharing cells: on an
+ * axis, its slab start must lie after the lower rank of every pair and at or
+ * before the higher one, between two distinct coordinates, and not at avoid
+ * on that axis. The axis and start are tried from a random place.
+ * @return 1 with the line in *axis and *start, or 0 if there is none
+ */
+int local_repair(mylocal *l, int avoid_axis, int avoid, int *axis, int *start) {
+    const int first = (int)(next_random(&l->rng) & 1);
+    int t = 0;
+    for (; t < 2; t++) {
+        const int a = first ^ t;
+        int lo = 1;
+        int hi = (int)num_points - 1;
+        unsigned int i = 0;
+        for (; i < l->num_pairs && lo <= hi; i++) {
+            int rp = l->rank[a][l->pairs[2 * i]];
+            int rq = l->rank[a][l->pairs[2 * i + 1]];
+            int low = rp < rq ? rp : rq;
+            int high = rp < rq ? rq : rp;
+            lo = low + 1 > lo ? low + 1 : lo;
+            hi = high < hi ? high : hi;
+        }
+        if (lo > hi) {
+            continue;
+        }
+        const int span = hi - lo + 1;
+        const int offset = (int)random_below(&l->rng, (unsigned int)span);
+        int k = 0;
+        for (; k < span; k++) {
+            const int s = lo + (offset + k) % span;
+            if (l->sorted[a][s - 1] != l->sorted[a][s] && !(a == avoid_axis && s == avoid)) {
+                *axis = a;
+                *start = s;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Takes out the line starting slab j of an axis, in O(lines).
+ */
+void local_remove(mylocal *l, int axis, unsigned int j) {
+    memmove(&l->bounds[axis][j], &l->bounds[axis][j + 1], sizeof (int) * (l->num_bounds[axis] - j));
+    l->num_bounds[axis]--;
+}
+
+/**
+ * Adds a line starting a slab at a rank of an axis, in O(lines).
+ */
+void local_insert(mylocal *l, int axis, int start) {
+    unsigned int j = l->num_bounds[axis] + 1;
+    for (; l->bounds[axis][j - 1] > start; j--) {
+        l->bounds[axis][j] = l->bounds[axis][j - 1];
+    }
+    l->bounds[axis][j] = start;
+    l->num_bounds[axis]++;
+}
+
+/**
+ * Returns the index in bounds of the line starting a slab at start.
+ */
+unsigned int local_find(const mylocal *l, int axis, int start) {
+    unsigned int lo = 1;
+    unsigned int hi = l->num_bounds[axis] - 1;
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (l->bounds[axis][mid] < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Improves a solution separating all points by local search, for improve_ms
+ * milliseconds or improve_moves moves, whichever ends first. A move picks a
+ * line at random and takes it out if no points end up sharing a cell.
+ * Otherwise it takes out a second line too, a neighbour of the same axis or
+ * any line, and puts in one line separating every pair left together, if
+ * there is one; failing that it swaps the first line for one separating its
+ * pairs, so that the search moves on among solutions of as many lines. A
+ * move costs O(k log n) for the k points of the slabs its lines close. The
+ * moves only depend on the seed, so a budget of moves gives the same lines
+ * on every machine.
+ * @return the number of lines removed
+ */
+unsigned int improve_solution(const myinstance *inst, mysolution *sol) {
+    struct timespec start;
+    mylocal l;
+    unsigned int before = sol->num_lines;
+    unsigned long long moves = 0;
+    unsigned int dropped = 0;
+    unsigned int merged = 0;
+    unsigned int swapped = 0;
+    unsigned int i = 0;
+    int a = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    load_instance(inst);
+    rank_points();
+    pre_separate();
+
+    l.order[V] = x_order;
+    l.order[H] = y_order;
+    l.rank[V] = x_rank;
+    l.rank[H] = y_rank;
+    l.sorted[V] = x_sorted;
+    l.sorted[H] = y_sorted;
+    l.pairs = arena_alloc(sizeof (int) * 2 * num_points);
+    l.rng = restart_seed ^ ((uint64_t)num_points << 32);
+    l.gone[V][0] = l.gone[V][1] = l.gone[H][0] = l.gone[H][1] = -1;
+    cellset_init(&l.cells, num_points);
+    for (a = 0; a < 2; a++) {
+        l.bounds[a] = arena_alloc(sizeof (int) * (num_points + 2));
+        l.bounds[a][0] = 0;
+        l.bounds[a][1] = (int)num_points;
+        l.num_bounds[a] = 1;
+    }
+    /// lines splitting nothing or the same ranks as another line go at once
+    for (; i < sol->num_lines; i++) {
+        int closest = closest_point(&sol->lines[i]);
+        a = sol->lines[i].axis;
+        if (closest >= 0 && local_slab(&l, a, closest + 1) != closest + 1) {
+            local_insert(&l, a, closest + 1);
+        }
+    }
+
+    /// a solution leaving points together, as with --max-lines, is left as it is
+    l.num_pairs = 0;
+    if (!local_place(&l, V, 0, (int)num_points, -1, 0, 0) || l.num_pairs > 0) {
+        restore();
+        return 0;
+    }
+
+    while ((improve_moves == 0 || moves < improve_moves)
+           && (improve_ms == 0 || (moves % 64 != 0 || elapsed_ms(&start) < improve_ms))) {
+        const unsigned int lines = l.num_bounds[V] + l.num_bounds[H] - 2;
+        int swap_axis = -1;
+        int swap_start = 0;
+        int new_axis, new_start;
+        if (lines == 0) {
+            break;
+        }
+        moves++;
+        unsigned int pick = (unsigned int)random_below(&l.rng, lines);
+        a = pick < l.num_bounds[V] - 1 ? V : H;
+        unsigned int j = 1 + (a == V ? pick : pick - (l.num_bounds[V] - 1));
+        const int gone = l.bounds[a][j];
+
+        if (local_collide(&l, a, j, -1, 0)) {
+            if (l.num_pairs == 0) {
+                local_remove(&l, a, j);
+                dropped++;
+                continue;
+            }
+            if (local_repair(&l, a, gone, &new_axis, &new_start)) {
+                swap_axis = new_axis;
+                swap_start = new_start;
+            }
+        }
+
+        /// a neighbour of the same axis, or any other line
+        int a2 = a;
+        unsigned int j2;
+        if (next_random(&l.rng) & 1) {
+            if (l.num_bounds[a] < 3) {
+                j2 = 0;
+            } else if (j == 1 || j + 1 == l.num_bounds[a]) {
+                j2 = j == 1 ? 2 : j - 1;
+            } else {
+                j2 = (next_random(&l.rng) & 1) ? j + 1 : j - 1;
+            }
+        } else {
+            unsigned int other = (unsigned int)random_below(&l.rng, lines);
+            a2 = other < l.num_bounds[V] - 1 ? V : H;
+            j2 = 1 + (a2 == V ? other : other - (l.num_bounds[V] - 1));
+            if (a2 == a && j2 == j) {
+                j2 = 0;
+            }
+        }
+        if (j2 > 0 && local_collide(&l, a, j, a2, j2)
+            && (l.num_pairs == 0 || local_repair(&l, -1, -1, &new_axis, &new_start))) {
+            const int gone2 = l.bounds[a2][j2];
+            local_remove(&l, a, j);
+            local_remove(&l, a2, local_find(&l, a2, gone2));
+            if (l.num_pairs > 0) {
+                local_insert(&l, new_axis, new_start);
+                merged++;
+            } else {
+                dropped += 2;
+            }
+            continue;
+        }
+        if (swap_axis >= 0) {
+            local_remove(&l, a, j);
+            local_insert(&l, swap_axis, swap_start);
+            swapped++;
+        }
+    }
+
+    sol->num_lines = 0;
+    for (a = 0; a < 2; a++) {
+        const unsigned int first = a == V ? 0 : num_points - 1;
+        for (i = 1; i < l.num_bounds[a]; i++) {
+            add_solution_line(sol, a, all_lines[first + (unsigned int)l.bounds[a][i] - 1].coord);
+        }
+    }
+    restore();
+    printf("%s: local search went from %u to %u lines in %ld ms (%llu moves: %u lines dropped, "
+           "%u pairs merged, %u swapped).\n", inst->job->name, before, sol->num_lines,
+           elapsed_ms(&start), moves, dropped, merged, swapped);
+    return before - sol->num_lines;
+}
+
+/**
+ * Finishes a solution: improves it by local search if asked to, and reports
+ * its gap to the lower bound if asked to.
+ * @param partial - whether the solution leaves points sharing cells
+ */
+void finish_solution(const myinstance *inst, mysolution *sol, int partial) {
+    if (improve_ms > 0 || improve_moves > 0) {
+        improve_solution(inst, sol);
+    }
+    if (report_bounds) {
+        report_gap(inst, sol->num_lines, partial);
+    }
+}
+
+/**
+ * Reports why an instance read by read_file() cannot be used, if it cannot.
+ * @param inst - the instance
+ * @return 1 if the instance was read successfully, 0 otherwise
+ */
+int report_status(const myinstance *inst) {
+    switch (inst->status) {
+        case FILE_NOT_EXISTS:
+            printf("No %s found.\n", inst->job->name);
+            return 0;
+
+        case FILE_ERROR_POINTS:
+            printf("%s has incorrect number of points.\n", inst->job->name);
+            return 0;
+
+        case FILE_NO_POINTS:
+            printf("There are no points in %s\n", inst->job->name);
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Solves an instance read by read_file(), or reports why it cannot be solved.
+ * @param inst - the instance
+ * @param sol - receives the committed lines
+ * @return 1 if the instance was solved, 0 otherwise
+ */
+int solve_instance(const myinstance *inst, mysolution *sol) {
+    if (!report_status(inst)) {
+        return 0;
+    }
+    if ((coarse && solve_coarse(inst, sol)) || (beam_width > 0 && solve_beam(inst, sol))) {
+        finish_solution(inst, sol, 0);
+        return 1;
+    }
+    if (restart_pool != NULL) {
+        int partial = solve_restarts(inst, sol);
+        finish_solution(inst, sol, partial);
+        return 1;
+    }
+
+    load_instance(inst);
+    solve();
+    if (approx_samples > 0 && storage != UPPER) {
+        printf("%s: %u lines picked from estimates, %u confirmed exactly.\n",
+               inst->job->name, approx_picks, approx_confirmed);
+    }
+    if (stopped_early) {
+        printf("%s stopped%s at %u lines with %llu pairs still linked.\n", inst->job->name,
+               out_of_time ? " out of time" : "", num_lines, pairs_left);
+        print_occupancy();
+        num_out_of_time += out_of_time;
+    } else if (out_of_time) {
+        printf("%s ran out of time after %u lines with %llu pairs still linked; %u more lines cut the rest.\n",
+               inst->job->name, greedy_lines, pairs_left, num_lines - greedy_lines);
+        num_out_of_time++;
+    }
+    if (num_points <= exact_max && num_lines > 1 && !stopped_early) {
+        unsigned int greedy = num_lines;
+        unsigned long long nodes;
+        if (exact_search(&nodes)) {
+            printf("%s: %u lines are optimal, the greedy has %u (%llu nodes searched).\n",
+                   inst->job->name, num_lines, greedy, nodes);
+        } else {
+            printf("%s: the exact search ran out of time at %u lines, the greedy has %u (%llu nodes searched).\n",
+                   inst->job->name, num_lines, greedy, nodes);
+            /// an instance whose greedy ran out of time too is counted once
+            num_out_of_time += !out_of_time;
+        }
+    }
+    if (prune) {
+        num_pruned += prune_lines();
+    }
+    store_solution(inst->job, sol);
+    restore();
+    finish_solution(inst, sol, stopped_early);
+    return 1;
+}
+
+/**
+ * Reads, solves and writes the instances one after the other.
+ * @return the number of solved instances
+ */
+int run_sequential() {
+    myinstance inst = {0};
+    mysolution sol = {0};
+    unsigned int j = 0;
+    int file_num = 0;
+    for (; j < num_jobs; j++) {
+        read_file(&jobs[j], &inst);
+        if (solve_instance(&inst, &sol)) {
+            write_file(&sol);
+            file_num++;
+        }
+    }
+    free_instance(&inst);
+    free(sol.lines);
+    return file_num;
+}
+
+void queue_init(myqueue *q, int capacity) {
+    q->items = malloc(sizeof (void *) * capacity);
+    q->capacity = capacity;
+    q->head = 0;
+    q->count = 0;
+    q->closed = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+}
+
+void queue_destroy(myqueue *q) {
+    free(q->items);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+}
+
+/**
+ * Appends an item, waiting while the queue is full.
+ */
+void queue_push(myqueue *q, void *item) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->capacity) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->items[(q->head + q->count) % q->capacity] = item;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * Removes the oldest item, waiting while the queue is empty and open.
+ * @return the item, or NULL once the queue is closed and drained
+ */
+void *queue_pop(myqueue *q) {
+    void *item = NULL;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    if (q->count > 0) {
+        item = q->items[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return item;
+}
+
+/**
+ * Tells the consumer that no more items will come.
+ */
+void queue_close(myqueue *q) {
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * The queues of the pipeline. Instances and solutions circulate between a
+ * free queue and a work queue, so at most depth + 1 of each exist and their
+ * buffers are reused.
+ */
+typedef struct Pipeline {
+    myqueue free_instances;
+    myqueue read_instances;
+    myqueue free_solutions;
+    myqueue solved;
+} mypipeline;
+
+/**
+ * The prefetch stage: reads instances ahead of the solver.
+ */
+void *read_stage(void *arg) {
+    mypipeline *p = arg;
+    unsigned int j = 0;
+    for (; j < num_jobs; j++) {
+        myinstance *inst = queue_pop(&p->free_instances);
+        read_file(&jobs[j], inst);
+        queue_push(&p->read_instances, inst);
+    }
+    queue_close(&p->read_instances);
+    return NULL;
+}
+
+/**
+ * The writer stage: flushes solutions behind the solver.
+ */
+void *write_stage(void *arg) {
+    mypipeline *p = arg;
+    mysolution *sol;
+    while ((sol = queue_pop(&p->solved)) != NULL) {
+        write_file(sol);
+        queue_push(&p->free_solutions, sol);
+    }
+    return NULL;
+}
+
+/**
+ * Reads instances k+1 to k+depth and writes solutions before k while
+ * instance k is solved on the calling thread.
+ * @param depth - how many instances are read ahead
+ * @return the number of solved instances
+ */
+int run_pipeline(int depth) {
+    mypipeline p;
+    myinstance *insts = calloc(depth + 1, sizeof (myinstance));
+    mysolution *sols = calloc(depth + 1, sizeof (mysolution));
+    pthread_t reader, writer;
+    int file_num = 0;
+    int i = 0;
+
+    queue_init(&p.free_instances, depth + 1);
+    queue_init(&p.read_instances, depth + 1);
+    queue_init(&p.free_solutions, depth + 1);
+    queue_init(&p.solved, depth + 1);
+    for (; i <= depth; i++) {
+        queue_push(&p.free_instances, &insts[i]);
+        queue_push(&p.free_solutions, &sols[i]);
+    }
+    pthread_create(&reader, NULL, read_stage, &p);
+    pthread_create(&writer, NULL, write_stage, &p);
+
+    myinstance *inst;
+    while ((inst = queue_pop(&p.read_instances)) != NULL) {
+        mysolution *sol = queue_pop(&p.free_solutions);
+        if (solve_instance(inst, sol)) {
+            queue_push(&p.solved, sol);
+            file_num++;
+        } else {
+            queue_push(&p.free_solutions, sol);
+        }
+        queue_push(&p.free_instances, inst);
+    }
+    queue_close(&p.solved);
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+
+    for (i = 0; i <= depth; i++) {
+        free_instance(&insts[i]);
+        free(sols[i].lines);
+    }
+    free(insts);
+    free(sols);
+    queue_destroy(&p.free_instances);
+    queue_destroy(&p.read_instances);
+    queue_destroy(&p.free_solutions);
+    queue_destroy(&p.solved);
+    return file_num;
+}
+
+
+/**
+ * Returns the size of a record name padded to 8 bytes.
+ */
+static inline uint64_t record_name_size(uint32_t name_len) {
+    return ((uint64_t)name_len + 7) / 8 * 8;
+}
+
+void container_close(mycontainer *c);
+
+/**
+ * Opens a container and maps it into memory.
+ * @param c - the container to fill in
+ * @param path - the path of the container file
+ * @param magic - the expected magic string
+ * @return 1 on success, 0 if the file cannot be mapped or is not such a container
+ */
+int container_open(mycontainer *c, const char *path, const char *magic) {
+    struct stat st;
+    memset(c, 0, sizeof (mycontainer));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open container %s\n", path);
+        return 0;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof (mycontainer_header)) {
+        printf("%s is not a container\n", path);
+        close(fd);
+        return 0;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Cannot map container %s\n", path);
+        return 0;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    c->data = data;
+    c->size = st.st_size;
+
+    const mycontainer_header *header = data;
+    if (memcmp(header->magic, magic, CONTAINER_MAGIC_SIZE) != 0
+        || header->index_offset > c->size
+        || header->count > (c->size - header->index_offset) / sizeof (uint64_t)) {
+        printf("%s is not a valid container\n", path);
+        container_close(c);
+        return 0;
+    }
+    c->count = header->count;
+    c->index = (const uint64_t *)(c->data + header->index_offset);
+    return 1;
+}
+
+void container_close(mycontainer *c) {
+    if (c->data != NULL) {
+        munmap((void *)c->data, c->size);
+    }
+    c->data = NULL;
+}
+
+/**
+ * Seeks to a record of a container.
+ * @param c - the container
+ * @param i - the record index
+ * @param item_size - the size of one point or line in the payload
+ * @return the record header, followed by its name and payload, or NULL if it
+ * does not fit in the file
+ */
+const myrecord_header *container_record(const mycontainer *c, uint64_t i, size_t item_size) {
+    uint64_t offset = c->index[i];
+    if (offset % 8 != 0 || offset > c->size || c->size - offset < sizeof (myrecord_header)) {
+        return NULL;
+    }
+    const myrecord_header *rec = (const myrecord_header *)(c->data + offset);
+    uint64_t size = sizeof (myrecord_header) + record_name_size(rec->name_len)
+                    + (uint64_t)rec->count * item_size;
+    if (size > c->size - offset) {
+        return NULL;
+    }
+    return rec;
+}
+
+const char *record_name(const myrecord_header *rec) {
+    return (const char *)(rec + 1);
+}
+
+const void *record_payload(const myrecord_header *rec) {
+    return (const char *)(rec + 1) + record_name_size(rec->name_len);
+}
+
+/**
+ * Starts writing a container. The header is rewritten by writer_close().
+ * @return 1 on success, 0 if the file cannot be created
+ */
+int writer_open(mywriter *w, const char *path, const char *magic) {
+    mycontainer_header header;
+    memset(w, 0, sizeof (mywriter));
+    w->file = fopen(path, "wb");
+    if (w->file == NULL) {
+        printf("Cannot write container %s\n", path);
+        return 0;
+    }
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, magic, CONTAINER_MAGIC_SIZE);
+    memcpy(w->magic, magic, CONTAINER_MAGIC_SIZE);
+    fwrite(&header, sizeof header, 1, w->file);
+    w->pos = sizeof header;
+    return 1;
+}
+
+/**
+ * Appends a record made of a name and up to two payload arrays.
+ * @param count - the number of points or lines in the record
+ */
+void writer_add(mywriter *w, const char *name, uint32_t count,
+                const void *first, size_t first_size, const void *second, size_t second_size) {
+    static const char padding[8] = {0};
+    myrecord_header rec;
+    if (w->count == w->capacity) {
+        w->capacity = w->capacity == 0 ? 1024 : w->capacity * 2;
+        w->offsets = realloc(w->offsets, sizeof (uint64_t) * w->capacity);
+        if (w->offsets == NULL) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+    }
+    w->offsets[w->count++] = w->pos;
+    rec.count = count;
+    rec.name_len = (uint32_t)strlen(name);
+    fwrite(&rec, sizeof rec, 1, w->file);
+    fwrite(name, 1, rec.name_len, w->file);
+    fwrite(padding, 1, record_name_size(rec.name_len) - rec.name_len, w->file);
+    if (first_size > 0) {
+        fwrite(first, 1, first_size, w->file);
+    }
+    if (second_size > 0) {
+        fwrite(second, 1, second_size, w->file);
+    }
+    w->pos += sizeof rec + record_name_size(rec.name_len) + first_size + second_size;
+}
+
+/**
+ * Writes the offset index and the header and closes the container.
+ * @return 1 on success, 0 if a write failed
+ */
+int writer_close(mywriter *w) {
+    mycontainer_header header;
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, w->magic, CONTAINER_MAGIC_SIZE);
+    header.count = w->count;
+    header.index_offset = w->pos;
+    if (w->count > 0) {
+        fwrite(w->offsets, sizeof (uint64_t), w->count, w->file);
+    }
+    fseek(w->file, 0, SEEK_SET);
+    fwrite(&header, sizeof header, 1, w->file);
+    int ok = !ferror(w->file);
+    ok = fclose(w->file) == 0 && ok;
+    free(w->offsets);
+    return ok;
+}
+
+/**
+ * Packs the input files of all jobs into one instance container.
+ * @param path - the container to write
+ * @return the number of packed instances, or -1 on error
+ */
+int pack_jobs(const char *path) {
+    mywriter w;
+    myinstance inst = {0};
+    unsigned int j = 0;
+    int packed = 0;
+    if (!writer_open(&w, path, INSTANCES_MAGIC)) {
+        return -1;
+    }
+    for (; j < num_jobs; j++) {
+        read_file(&jobs[j], &inst);
+        /// reports files that cannot be packed
+        if (!report_status(&inst)) {
+            continue;
+        }
+        writer_add(&w, jobs[j].name, inst.num_points, inst.x, sizeof (int32_t) * inst.num_points,
+                   inst.y, sizeof (int32_t) * inst.num_points);
+        packed++;
+    }
+    free_instance(&inst);
+    if (!writer_close(&w)) {
+        printf("Cannot write container %s\n", path);
+        return -1;
+    }
+    return packed;
+}
+
+/**
+ * Solves every instance of a container and writes their solutions, in the
+ * same order and under the same names, to a solution container.
+ * @param path - the instance container
+ * @param out_path - the solution container
+ * @return the number of solved instances, or -1 on error
+ */
+int run_container(const char *path, const char *out_path) {
+    mycontainer c;
+    mywriter w;
+    mysolution sol = {0};
+    uint64_t i = 0;
+    int file_num = 0;
+    if (!container_open(&c, path, INSTANCES_MAGIC)) {
+        return -1;
+    }
+    if (!writer_open(&w, out_path, SOLUTIONS_MAGIC)) {
+        container_close(&c);
+        return -1;
+    }
+    for (; i < c.count; i++) {
+        const myrecord_header *rec = container_record(&c, i, 2 * sizeof (int32_t));
+        if (rec == NULL) {
+            printf("Record %lu of %s is corrupt.\n", (unsigned long)i, path);
+            continue;
+        }
+        if (rec->count == 0) {
+            printf("There are no points in %.*s\n", (int)rec->name_len, record_name(rec));
+            continue;
+        }
+        /// the instance points into the mapped record, which the solvers only read
+        char name[CONTAINER_NAME_MAX + 1];
+        snprintf(name, sizeof name, "%.*s", (int)rec->name_len, record_name(rec));
+        int32_t *x = (int32_t *)record_payload(rec);
+        myjob job = {NULL, NULL, name};
+        myinstance inst = {0};
+        inst.job = &job;
+        inst.status = FILE_SUCCESS;
+        inst.num_points = rec->count;
+        inst.x = x;
+        inst.y = x + rec->count;
+        if (!solve_instance(&inst, &sol)) {
+            continue;
+        }
+        writer_add(&w, name, sol.num_lines, sol.lines, sizeof (myline) * sol.num_lines, NULL, 0);
+        file_num++;
+    }
+    container_close(&c);
+    free(sol.lines);
+    if (!writer_close(&w)) {
+        printf("Cannot write container %s\n", out_path);
+        return -1;
+    }
+    return file_num;
+}
+
+/**
+ * Writes every solution of a solution container as a text file, named as a
+ * directory scan would name it.
+ * @param path - the solution container
+ * @param output_dir - the directory of the text files
+ * @return the number of written solutions, or -1 on error
+ */
+int unpack_solutions(const char *path, const char *output_dir) {
+    mycontainer c;
+    uint64_t i = 0;
+    int file_num = 0;
+    if (!container_open(&c, path, SOLUTIONS_MAGIC)) {
+        return -1;
+    }
+    for (; i < c.count; i++) {
+        const myrecord_header *rec = container_record(&c, i, sizeof (myline));
+        if (rec == NULL) {
+            printf("Record %lu of %s is corrupt.\n", (unsigned long)i, path);
+            continue;
+        }
+        char name[CONTAINER_NAME_MAX + 1];
+        snprintf(name, sizeof name, "%.*s", (int)rec->name_len, record_name(rec));
+        add_found_job(name, output_dir);
+
+        mysolution sol;
+        sol.job = &jobs[num_jobs - 1];
+        sol.num_lines = rec->count;
+        sol.lines = (myline *)record_payload(rec);
+        write_file(&sol);
+        file_num++;
+    }
+    container_close(&c);
+    return file_num;
+}
+
+/**
+ * Orders doubles ascending, for qsort.
+ */
+int double_compare(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * Reads the lines of a solution file, sorted by coordinate per axis, into
+ * memory from the arena; on failure the arena is reset and the reason printed.
+ * @param text - the buffer the solution file is read into
+ * @param coords - receives the coordinates of the lines of each axis
+ * @param num_coords - receives the number of lines of each axis
+ * @return the number of lines, or -1 on failure
+ */
+int read_solution(mytext *text, const char *path, double *coords[2], unsigned int num_coords[2]) {
+    int declared = 0;
+    if (!load_text(text, path)) {
+        printf("No %s found.\n", path);
+        return -1;
+    }
+    if (!next_int(text, &declared) || declared < 0) {
+        printf("%s: no number of lines.\n", path);
+        return -1;
+    }
+
+    /// the declared count is not trusted: a line takes at least "v 1\n", the last one without the newline
+    size_t capacity = (text->size + 1) / 4;
+    if ((size_t)declared < capacity) {
+        capacity = (size_t)declared;
+    }
+    coords[V] = arena_alloc(sizeof (double) * capacity);
+    coords[H] = arena_alloc(sizeof (double) * capacity);
+    num_coords[V] = 0;
+    num_coords[H] = 0;
+    unsigned int count = 0;
+    int axis;
+    double coord;
+    while (next_line(text, &axis, &coord)) {
+        if (count < capacity) {
+            coords[axis][num_coords[axis]++] = coord;
+        }
+        count++;
+    }
+    if (!text_end(text)) {
+        printf("%s: malformed line %u.\n", path, count + 1);
+        arena_reset();
+        return -1;
+    }
+    if (count != (unsigned int)declared) {
+        printf("%s has %u lines, not %d.\n", path, count, declared);
+        arena_reset();
+        return -1;
+    }
+    qsort(coords[V], num_coords[V], sizeof (double), double_compare);
+    qsort(coords[H], num_coords[H], sizeof (double), double_compare);
+    return (int)count;
+}
+
+/**
+ * Checks that the lines of a solution file separate every two points of its
+ * instance, in O((n + L) log L) for n points and L lines: the lines of each
+ * axis are sorted, every point is located in its cell by binary search, and
+ * points landing in an occupied cell are reported.
+ * @param inst - the instance, as read by read_file()
+ * @param text - the buffer the solution file is read into
+ * @return 1 if the solution is valid, 0 otherwise
+ */
+int verify_solution(const myinstance *inst, mytext *text) {
+    const char *path = inst->job->output;
+    double *coords[2];
+    unsigned int num_coords[2];
+    if (!report_status(inst)) {
+        return 0;
+    }
+    int count = read_solution(text, path, coords, num_coords);
+    if (count < 0) {
+        return 0;
+    }
+
+    mycellset cells;
+    unsigned int collisions = 0;
+    unsigned int i = 0;
+    cellset_init(&cells, inst->num_points);
+    for (; i < inst->num_points; i++) {
+        unsigned int v_slab = slab_index(coords[V], num_coords[V], inst->x[i]);
+        unsigned int h_slab = slab_index(coords[H], num_coords[H], inst->y[i]);
+        int other = cellset_insert(&cells, cell_key(v_slab, h_slab), (int)i);
+        if (other >= 0 && collisions++ == 0) {
+            printf("%s: points %d (%d, %d) and %u (%d, %d) are not separated.\n", path,
+                   other + 1, inst->x[other], inst->y[other], i + 1, inst->x[i], inst->y[i]);
+        }
+    }
+    arena_reset();
+
+    if (collisions > 0) {
+        printf("%s: FAILED, %u of %u points share a cell with an earlier point.\n",
+               path, collisions, inst->num_points);
+        return 0;
+    }
+    printf("%s: OK, %d lines separate %u points.\n", path, count, inst->num_points);
+    return 1;
+}
+
+/**
+ * Verifies the solution file of every job against its input file.
+ * @return the number of valid solutions
+ */
+int run_verify() {
+    myinstance inst = {0};
+    mytext text = {0};
+    unsigned int j = 0;
+    int valid = 0;
+    for (; j < num_jobs; j++) {
+        read_file(&jobs[j], &inst);
+        valid += verify_solution(&inst, &text);
+    }
+    free_instance(&inst);
+    free(text.data);
+    return valid;
+}
+
+
+/**
+ * Grows the point arrays of a dynamic point set to hold n ids.
+ */
+void dynamic_reserve_points(mydynamic *d, unsigned int n) {
+    if (n <= d->capacity) {
+        return;
+    }
+    d->capacity = n > 2 * d->capacity ? n : 2 * d->capacity;
+    d->x = grow_array(d->x, sizeof (int) * d->capacity);
+    d->y = grow_array(d->y, sizeof (int) * d->capacity);
+    d->alive = grow_array(d->alive, d->capacity);
+    d->slab[V] = grow_array(d->slab[V], sizeof (unsigned int) * d->capacity);
+    d->slab[H] = grow_array(d->slab[H], sizeof (unsigned int) * d->capacity);
+}
+
+void dynamic_reserve_lines(mydynamic *d, int axis) {
+    if (d->num_coords[axis] == d->coords_capacity[axis]) {
+        d->coords_capacity[axis] = d->coords_capacity[axis] == 0 ? 64 : 2 * d->coords_capacity[axis];
+        d->coords[axis] = grow_array(d->coords[axis], sizeof (double) * d->coords_capacity[axis]);
+    }
+}
+
+static inline uint64_t dynamic_key(const mydynamic *d, unsigned int i) {
+    return cell_key(d->slab[V][i], d->slab[H][i]);
+}
+
+/**
+ * Puts every live point back into its cell, after the lines changed.
+ */
+void dynamic_index(mydynamic *d) {
+    size_t slots = 16;
+    unsigned int i = 0;
+    while (slots < 2 * (size_t)d->num_points) {
+        slots <<= 1;
+    }
+    if (slots > d->cell_slots) {
+        d->cells.keys = grow_array(d->cells.keys, sizeof (uint64_t) * slots);
+        d->cells.ids = grow_array(d->cells.ids, sizeof (int) * slots);
+        d->merge.keys = grow_array(d->merge.keys, sizeof (uint64_t) * slots);
+        d->merge.ids = grow_array(d->merge.ids, sizeof (int) * slots);
+        d->cell_slots = slots;
+    }
+    cellset_clear(&d->cells, d->num_points);
+    for (; i < d->num_points; i++) {
+        if (d->alive[i]) {
+            cellset_insert(&d->cells, dynamic_key(d, i), (int)i);
+        }
+    }
+}
+
+/**
+ * Adds a line and moves the points beyond it into the next slab, in O(n).
+ */
+void dynamic_add_line(mydynamic *d, int axis, double coord) {
+    const int *c = axis == V ? d->x : d->y;
+    unsigned int j = 0;
+    unsigned int i = 0;
+    dynamic_reserve_lines(d, axis);
+    while (j < d->num_coords[axis] && d->coords[axis][j] < coord) {
+        j++;
+    }
+    memmove(&d->coords[axis][j + 1], &d->coords[axis][j], sizeof (double) * (d->num_coords[axis] - j));
+    d->coords[axis][j] = coord;
+    d->num_coords[axis]++;
+    for (; i < d->num_points; i++) {
+        d->slab[axis][i] += c[i] > coord;
+    }
+    dynamic_index(d);
+}
+
+/**
+ * Removes line j of an axis and merges the slabs on its two sides, in O(n).
+ */
+void dynamic_remove_line(mydynamic *d, int axis, unsigned int j) {
+    unsigned int i = 0;
+    memmove(&d->coords[axis][j], &d->coords[axis][j + 1], sizeof (double) * (d->num_coords[axis] - j - 1));
+    d->num_coords[axis]--;
+    for (; i < d->num_points; i++) {
+        d->slab[axis][i] -= d->slab[axis][i] > j;
+    }
+    dynamic_index(d);
+}
+
+/**
+ * Tells whether line j of an axis is needed, i.e. whether merging the two
+ * slabs on its sides would put two live points into one cell.
+ */
+int dynamic_line_needed(mydynamic *d, int axis, unsigned int j) {
+    unsigned int i = 0;
+    cellset_clear(&d->merge, d->num_points);
+    for (; i < d->num_points; i++) {
+        if (d->alive[i] && (d->slab[axis][i] == j || d->slab[axis][i] == j + 1)
+            && cellset_insert(&d->merge, cell_key(0, d->slab[1 - axis][i]), (int)i) >= 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Solves the live points from scratch with the greedy and takes its lines.
+ * Deleted points are dropped and the live ones renumbered.
+ */
+void dynamic_solve(mydynamic *d) {
+    unsigned int i = 0;
+    unsigned int n = 0;
+    int *xy = grow_array(NULL, sizeof (int) * 2 * (d->num_alive + 1));
+    for (; i < d->num_points; i++) {
+        if (d->alive[i]) {
+            xy[2 * n] = d->x[i];
+            xy[2 * n + 1] = d->y[i];
+            n++;
+        }
+    }
+    /// the solver expects the points sorted by x
+    qsort(xy, n, 2 * sizeof (int), xy_compare);
+    for (i = 0; i < n; i++) {
+        d->x[i] = xy[2 * i];
+        d->y[i] = xy[2 * i + 1];
+        d->alive[i] = 1;
+    }
+    free(xy);
+    d->num_points = n;
+    d->num_alive = n;
+    d->num_coords[V] = 0;
+    d->num_coords[H] = 0;
+
+    if (n > 0) {
+        load_points(n, d->x, d->y);
+        solve();
+        for (i = 0; i < num_lines; i++) {
+            int axis = final_lines[i]->axis;
+            dynamic_reserve_lines(d, axis);
+            d->coords[axis][d->num_coords[axis]++] = final_lines[i]->coord;
+        }
+        restore();
+    }
+    qsort(d->coords[V], d->num_coords[V], sizeof (double), double_compare);
+    qsort(d->coords[H], d->num_coords[H], sizeof (double), double_compare);
+    for (i = 0; i < n; i++) {
+        d->slab[V][i] = slab_index(d->coords[V], d->num_coords[V], d->x[i]);
+        d->slab[H][i] = slab_index(d->coords[H], d->num_coords[H], d->y[i]);
+    }
+    d->solved_lines = d->num_coords[V] + d->num_coords[H];
+    d->num_solves++;
+    dynamic_index(d);
+}
+
+/**
+ * Starts a dynamic point set from an instance and solves it.
+ * @param inst - the instance, as read by read_file()
+ * @param threshold - how much the lines may grow, as a fraction of the
+ * lines of the last full solve, before the points are solved again
+ */
+void dynamic_open(mydynamic *d, const myinstance *inst, double threshold) {
+    memset(d, 0, sizeof (mydynamic));
+    d->threshold = threshold;
+    dynamic_reserve_points(d, inst->num_points > 16 ? inst->num_points : 16);
+    memcpy(d->x, inst->x, sizeof (int) * inst->num_points);
+    memcpy(d->y, inst->y, sizeof (int) * inst->num_points);
+    memset(d->alive, 1, inst->num_points);
+    d->num_points = inst->num_points;
+    d->num_alive = inst->num_points;
+    dynamic_solve(d);
+}
+
+void dynamic_close(mydynamic *d) {
+    free(d->x);
+    free(d->y);
+    free(d->alive);
+    free(d->slab[V]);
+    free(d->slab[H]);
+    free(d->coords[V]);
+    free(d->coords[H]);
+    free(d->cells.keys);
+    free(d->cells.ids);
+    free(d->merge.keys);
+    free(d->merge.ids);
+}
+
+/**
+ * Inserts a point. If its cell holds a point already, one line is added
+ * between the two. Any such line separates exactly this one pair, so the
+ * local gain is equal and the axis with fewer lines is preferred, as even
+ * axes make the most cells per line. Once the lines have grown past the
+ * threshold, the points are solved again.
+ * @return 1 if the point was inserted, 0 if it is in the set already
+ */
+int dynamic_insert(mydynamic *d, int x, int y) {
+    dynamic_reserve_points(d, d->num_points + 1);
+    unsigned int id = d->num_points++;
+    d->x[id] = x;
+    d->y[id] = y;
+    d->alive[id] = 0;
+    d->slab[V][id] = slab_index(d->coords[V], d->num_coords[V], x);
+    d->slab[H][id] = slab_index(d->coords[H], d->num_coords[H], y);
+    if (2 * (size_t)d->num_points > d->cells.mask + 1) {
+        dynamic_index(d);
+    }
+
+    int other = cellset_insert(&d->cells, dynamic_key(d, id), (int)id);
+    if (other >= 0 && d->x[other] == x && d->y[other] == y) {
+        d->num_points--;
+        return 0;
+    }
+    d->alive[id] = 1;
+    d->num_alive++;
+    if (other < 0) {
+        return 1;
+    }
+    int axis = d->x[other] == x ? H
+             : d->y[other] == y ? V
+             : d->num_coords[V] <= d->num_coords[H] ? V : H;
+    double a = axis == V ? d->x[other] : d->y[other];
+    double b = axis == V ? x : y;
+    dynamic_add_line(d, axis, (a + b) / 2);
+    d->lines_added++;
+
+    unsigned int lines = d->num_coords[V] + d->num_coords[H];
+    if (lines > d->solved_lines && lines - d->solved_lines > d->threshold * d->solved_lines) {
+        dynamic_solve(d);
+    }
+    return 1;
+}
+
+/**
+ * Deletes a point, then removes the lines bounding its cell that no other
+ * pair of points needs.
+ * @return 1 if the point was deleted, 0 if it is not in the set
+ */
+int dynamic_delete(mydynamic *d, int x, int y) {
+    uint64_t key = cell_key(slab_index(d->coords[V], d->num_coords[V], x),
+                            slab_index(d->coords[H], d->num_coords[H], y));
+    int id = cellset_find(&d->cells, key);
+    int axis = 0;
+    if (id < 0 || d->x[id] != x || d->y[id] != y) {
+        return 0;
+    }
+    cellset_remove(&d->cells, key);
+    d->alive[id] = 0;
+    d->num_alive--;
+    for (; axis < 2; axis++) {
+        unsigned int s = d->slab[axis][id];
+        if (s < d->num_coords[axis] && !dynamic_line_needed(d, axis, s)) {
+            dynamic_remove_line(d, axis, s);
+            d->lines_removed++;
+        }
+        if (s > 0 && !dynamic_line_needed(d, axis, s - 1)) {
+            dynamic_remove_line(d, axis, s - 1);
+            d->lines_removed++;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Copies the lines of a dynamic point set into a solution.
+ */
+void dynamic_solution(const mydynamic *d, mysolution *sol) {
+    unsigned int total = d->num_coords[V] + d->num_coords[H];
+    unsigned int k = 0;
+    int axis = 0;
+    if (total > sol->capacity) {
+        sol->lines = grow_array(sol->lines, sizeof (myline) * total);
+        sol->capacity = total;
+    }
+    sol->num_lines = total;
+    for (; axis < 2; axis++) {
+        unsigned int j = 0;
+        for (; j < d->num_coords[axis]; j++, k++) {
+            sol->lines[k].axis = axis;
+            sol->lines[k].coord = (float)d->coords[axis][j];
+        }
+    }
+}
+
+/**
+ * Solves an instance, applies a file of updates to it, "+ x y" to insert a
+ * point and "- x y" to delete one, and writes the repaired solution where
+ * the solution of the instance goes.
+ * @param spec - "INSTANCE,UPDATES"
+ * @param output_dir - the directory of the solution
+ * @param threshold - see dynamic_open()
+ * @return 1 on success, 0 otherwise
+ */
+int run_updates(const char *spec, const char *output_dir, double threshold) {
+    char *instance = strdup(spec);
+    const char *updates = strchr(spec, ',') + 1;
+    myinstance inst = {0};
+    mytext text = {0};
+    mysolution sol = {0};
+    mydynamic d;
+    unsigned int num_updates = 0;
+    unsigned int rejected = 0;
+    struct timespec start;
+
+    *strchr(instance, ',') = '\0';
+    add_found_job(instance, output_dir);
+    free(instance);
+    read_file(&jobs[num_jobs - 1], &inst);
+    if (!report_status(&inst)) {
+        free_instance(&inst);
+        return 0;
+    }
+    if (!load_text(&text, updates)) {
+        printf("No %s found.\n", updates);
+        free_instance(&inst);
+        return 0;
+    }
+    dynamic_open(&d, &inst, threshold);
+    printf("%s: %u lines for %u points.\n", inst.job->name, d.solved_lines, d.num_alive);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        int x, y;
+        while (isspace((unsigned char)text.data[text.pos])) {
+            text.pos++;
+        }
+        char op = text.data[text.pos];
+        if (op != '+' && op != '-') {
+            break;
+        }
+        text.pos++;
+        if (!next_int(&text, &x) || !next_int(&text, &y)) {
+            break;
+        }
+        rejected += op == '+' ? !dynamic_insert(&d, x, y) : !dynamic_delete(&d, x, y);
+        num_updates++;
+    }
+    long ms = elapsed_ms(&start);
+    int ok = text_end(&text);
+    if (!ok) {
+        printf("%s: update %u is malformed.\n", updates, num_updates + 1);
+    }
+
+    dynamic_solution(&d, &sol);
+    sol.job = inst.job;
+    write_file(&sol);
+    printf("%s: %u updates (%u rejected) in %ld ms, %u lines added, %u removed, %u re-solves.\n",
+           updates, num_updates, rejected, ms, d.lines_added, d.lines_removed, d.num_solves - 1);
+    printf("%s: %u lines for %u points.\n", inst.job->name, sol.num_lines, d.num_alive);
+
+    dynamic_close(&d);
+    free(sol.lines);
+    free(text.data);
+    free_instance(&inst);
+    return ok;
+}
+
+
+/**
+ * Lays the sorted coordinates of one axis out in Eytzinger order: the
+ * subtree of node k holds nodes 2k and 2k + 1, and slab[k] is the index of
+ * the coordinate of node k in sorted order.
+ * @param next - the next sorted index to place, advanced as nodes are filled
  */
-mypoint mypoints[MAX_POINTS];
+void eytzinger_fill(const double *sorted, unsigned int count, double *eytz, unsigned int *slab,
+                    unsigned int k, unsigned int *next) {
+    if (k > count) {
+        return;
+    }
+    eytzinger_fill(sorted, count, eytz, slab, 2 * k, next);
+    eytz[k] = sorted[*next];
+    slab[k] = (*next)++;
+    eytzinger_fill(sorted, count, eytz, slab, 2 * k + 1, next);
+}
 
 /**
- * The arrays of pointers to point structs sorted by x- or y-coordinate.
- * Based on the project description, points in the input files are pre-sorted
- * by the x-coordinates.
+ * Returns the slab of a coordinate, as slab_index() does, by an Eytzinger
+ * search: the first levels of the tree share a few cache lines, so a
+ * search over millions of lines misses the cache far less than a binary
+ * search of the sorted array.
  */
-mypoint *x_points[MAX_POINTS];
-mypoint *y_points[MAX_POINTS];
+static inline unsigned int eytzinger_slab(const double *eytz, const unsigned int *slab, unsigned int count, int c) {
+    const double f = c;
+    unsigned int k = 1;
+    while (k <= count) {
+        k = 2 * k + (eytz[k] < f);
+    }
+    /// the last left turn leads to the first coordinate not less than f
+    while (k & 1) {
+        k >>= 1;
+    }
+    k >>= 1;
+    return k == 0 ? count : slab[k];
+}
+
+static inline unsigned int locate_slab(const mylocator *loc, int axis, int c) {
+    return eytzinger_slab(loc->eytz[axis], loc->slab[axis], loc->num_coords[axis], c);
+}
 
 /**
- * On the horizontal or vertical level, the lines needed at most to separate
- * two adjacent points, i.e. every two adjacent points has a line right in the
- * middle from the left to right or the bottom to top.
- * Note: the lines are not final.
+ * Returns the slab of a coordinate like slab_index(), searching outwards from
+ * the slab of the previous query in steps doubling in size, so that a query
+ * close to the previous one costs O(log d) for a distance of d slabs.
  */
-myline all_lines[MAX_POINTS * 2];
-myline *lines[MAX_POINTS * 2];
+unsigned int finger_slab(const double *coords, unsigned int count, unsigned int hint, int c) {
+    const double f = c;
+    unsigned int lo, hi, step = 1;
+    if (hint > count) {
+        hint = count;
+    }
+    if (hint > 0 && coords[hint - 1] >= f) {
+        hi = hint - 1;
+        while (hi >= step && coords[hi - step] >= f) {
+            hi -= step;
+            step <<= 1;
+        }
+        lo = hi >= step ? hi - step + 1 : 0;
+    } else {
+        lo = hint;
+        while (lo + step <= count && coords[lo + step - 1] < f) {
+            lo += step;
+            step <<= 1;
+        }
+        hi = lo + step <= count ? lo + step - 1 : count;
+    }
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (coords[mid] < f) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
 
 /**
- * The array of pointers to the finalized axis-parallel lines that optimally
- * separate points.
+ * Loads a solution for point location: reads its lines, lays them out for
+ * searching and puts every point of the instance into its cell.
+ * Its memory comes from the arena and is released by arena_reset().
+ * @param inst - the instance, as read by read_file()
+ * @param text - the buffer the solution file is read into
+ * @param path - the solution file
+ * @return 1 on success, 0 otherwise
  */
-myline *final_lines[MAX_POINTS];
-
-unsigned int num_points = 0;
-unsigned int num_edges = 0;
-unsigned int num_lines = 0;
-unsigned int num_all_lines = 0;
-
+int locator_open(mylocator *loc, const myinstance *inst, mytext *text, const char *path) {
+    unsigned int i = 0;
+    int a = 0;
+    int shared = 0;
+    loc->inst = inst;
+    if (read_solution(text, path, loc->coords, loc->num_coords) < 0) {
+        return 0;
+    }
+    for (; a < 2; a++) {
+        unsigned int next = 0;
+        loc->eytz[a] = arena_alloc(sizeof (double) * (loc->num_coords[a] + 1));
+        loc->slab[a] = arena_alloc(sizeof (unsigned int) * (loc->num_coords[a] + 1));
+        eytzinger_fill(loc->coords[a], loc->num_coords[a], loc->eytz[a], loc->slab[a], 1, &next);
+    }
+    cellset_init(&loc->cells, inst->num_points);
+    for (; i < inst->num_points; i++) {
+        uint64_t key = cell_key(locate_slab(loc, V, inst->x[i]), locate_slab(loc, H, inst->y[i]));
+        shared += cellset_insert(&loc->cells, key, (int)i) >= 0;
+    }
+    if (shared > 0) {
+        printf("%s: %d points share a cell with an earlier point, which owns the cell.\n", path, shared);
+    }
+    return 1;
+}
 
 /**
- * Reads an input .txt file and stores points' information.
- * @param id - the numerous part of the file name indicating file index.
- * @return - a file status
+ * Returns the point owning the cell of (x, y), or -1 if the cell is empty.
+ * @param v_slab - receives the slab of x among the vertical lines
+ * @param h_slab - receives the slab of y among the horizontal lines
  */
-int read_file(int id) {
-    char file_name[200];
-    sprintf(file_name, "input/instance%.2d.txt", id);
-
-    FILE *input = fopen(file_name, "r");
+int locate(const mylocator *loc, int x, int y, unsigned int *v_slab, unsigned int *h_slab) {
+    *v_slab = locate_slab(loc, V, x);
+    *h_slab = locate_slab(loc, H, y);
+    return cellset_find(&loc->cells, cell_key(*v_slab, *h_slab));
+}
 
-    if(input == NULL){
-        return FILE_NOT_EXISTS;
+/**
+ * Locates a stream of queries. While x does not decrease, the vertical slab
+ * is found by walking the sorted lines forward, so a stream sorted by x
+ * costs O(n + L) for the x-coordinates; y is found by a finger search from
+ * the previous query. Queries out of x order fall back to locate_slab().
+ * @param x - the x-coordinates of the queries
+ * @param y - the y-coordinates of the queries
+ * @param n - the number of queries
+ * @param v_slab - receives the vertical slab of every query
+ * @param h_slab - receives the horizontal slab of every query
+ * @param owner - receives the point owning the cell of every query, or -1
+ * @return the number of queries that were out of x order
+ */
+unsigned int locate_batch(const mylocator *loc, const int *x, const int *y, unsigned int n,
+                          unsigned int *v_slab, unsigned int *h_slab, int *owner) {
+    const double *v = loc->coords[V];
+    const unsigned int num_v = loc->num_coords[V];
+    unsigned int v_at = 0;
+    unsigned int h_at = 0;
+    unsigned int unsorted = 0;
+    unsigned int i = 0;
+    for (; i < n; i++) {
+        if (i > 0 && x[i] < x[i - 1]) {
+            v_at = locate_slab(loc, V, x[i]);
+            unsorted++;
+        } else {
+            while (v_at < num_v && v[v_at] < (double)x[i]) {
+                v_at++;
+            }
+        }
+        h_at = finger_slab(loc->coords[H], loc->num_coords[H], h_at, y[i]);
+        v_slab[i] = v_at;
+        h_slab[i] = h_at;
+        owner[i] = cellset_find(&loc->cells, cell_key(v_at, h_at));
     }
+    return unsorted;
+}
 
-    if(fscanf(input, "%d", &num_points) == EOF){
-        return FILE_NO_POINTS;
+/**
+ * Reads a file of queries, one "x y" per query.
+ * @param x - receives the x-coordinates, to be freed
+ * @param y - receives the y-coordinates, to be freed
+ * @param n - receives the number of queries
+ * @return 1 on success, 0 otherwise
+ */
+int read_queries(mytext *text, const char *path, int **x, int **y, unsigned int *n) {
+    unsigned int capacity = 0;
+    int qx, qy;
+    *x = NULL;
+    *y = NULL;
+    *n = 0;
+    if (!load_text(text, path)) {
+        printf("No %s found.\n", path);
+        return 0;
     }
-
-    /// Values scanned from the input file and stored as points' information
-    int i = 0;
-    int x = 0;
-    int y = 0;
-    while(fscanf(input, "%d %d", &x, &y) != EOF && i < MAX_POINTS){
-        mypoints[i].x = x;
-        mypoints[i].y = y;
-        x_points[i] = &(mypoints[i]);
-        y_points[i] = &(mypoints[i]);
-        i++;
+    while (next_int(text, &qx) && next_int(text, &qy)) {
+        if (*n == capacity) {
+            capacity = capacity == 0 ? 1024 : 2 * capacity;
+            *x = grow_array(*x, sizeof (int) * capacity);
+            *y = grow_array(*y, sizeof (int) * capacity);
+        }
+        (*x)[*n] = qx;
+        (*y)[*n] = qy;
+        (*n)++;
     }
-
-    if(i != num_points){
-        return FILE_ERROR_POINTS;
+    if (!text_end(text)) {
+        printf("%s: query %u is malformed.\n", path, *n + 1);
+        return 0;
     }
+    return 1;
+}
+
+/**
+ * Locates a batch of queries and writes one answer "v h p" per query: the
+ * slabs of the cell of (x, y) and the number of the input point owning it,
+ * or 0 if the cell holds no point.
+ * @return 1 on success, 0 if the answers cannot be written
+ */
+int answer_queries(const mylocator *loc, const int *x, const int *y, unsigned int n,
+                   const char *name, const char *path) {
+    unsigned int *v_slab = grow_array(NULL, sizeof (unsigned int) * (n + 1));
+    unsigned int *h_slab = grow_array(NULL, sizeof (unsigned int) * (n + 1));
+    int *owner = grow_array(NULL, sizeof (int) * (n + 1));
+    unsigned int owned = 0;
+    unsigned int i = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned int unsorted = locate_batch(loc, x, y, n, v_slab, h_slab, owner);
+    long ms = elapsed_ms(&start);
 
-    fclose(input);
-    return FILE_SUCCESS;
+    FILE *output = fopen(path, "w");
+    if (output != NULL) {
+        for (; i < n; i++) {
+            owned += owner[i] >= 0;
+            fprintf(output, "%u %u %d\n", v_slab[i], h_slab[i], owner[i] + 1);
+        }
+        fclose(output);
+        printf("%s: %u queries (%u out of x order) in %ld ms, %u in the cell of a point.\n",
+               name, n, unsorted, ms, owned);
+    } else {
+        printf("Cannot write %s\n", path);
+    }
+    free(v_slab);
+    free(h_slab);
+    free(owner);
+    return output != NULL;
 }
 
 /**
- * Writes the results into an output .txt file
- * @param id - the numerous part of the file name indicating file index
+ * Answers a file of point-location queries against a solution of an
+ * instance, see answer_queries().
+ * @param spec - "INSTANCE,SOLUTION,QUERIES"
+ * @param output_dir - where the answers go, as answers_<name of QUERIES>
+ * @return 1 on success, 0 otherwise
  */
-void write_file(int id){
-    char file_name[200];
-    sprintf(file_name, "output_greedy/greedy_solution%.2d.txt", id);
-    FILE *output = fopen(file_name, "w");
-    fprintf(output, "%d\n", num_lines);
+int run_queries(const char *spec, const char *output_dir) {
+    char *paths = strdup(spec);
+    char *solution = strchr(paths, ',') + 1;
+    char *queries = strchr(solution, ',') + 1;
+    const char *slash = strrchr(queries, '/');
+    const char *name = slash == NULL ? queries : slash + 1;
+    size_t size = strlen(output_dir) + strlen(name) + 16;
+    char *path = malloc(size);
+    myinstance inst = {0};
+    mytext text = {0};
+    mylocator loc;
+    int *x = NULL;
+    int *y = NULL;
+    unsigned int n = 0;
+    int ok = 0;
 
-    int i = 0;
-    for(; i < num_lines; i++){
-        if(final_lines[i]->axis == V) {
-            fprintf(output, "v ");
-        } else {
-            fprintf(output, "h ");
+    solution[-1] = '\0';
+    queries[-1] = '\0';
+    snprintf(path, size, "%s/answers_%s", output_dir, name);
+    add_job(paths, solution);
+    read_file(&jobs[num_jobs - 1], &inst);
+    if (report_status(&inst) && locator_open(&loc, &inst, &text, solution)) {
+        printf("%s: %u vertical and %u horizontal lines for %u points.\n", solution,
+               loc.num_coords[V], loc.num_coords[H], inst.num_points);
+        if (read_queries(&text, queries, &x, &y, &n)) {
+            ok = answer_queries(&loc, x, y, n, name, path);
         }
-        fprintf(output, "%.1f\n", final_lines[i]->coord);
+        arena_reset();
     }
-    fclose(output);
+    free(x);
+    free(y);
+    free(path);
+    free(paths);
+    free(text.data);
+    free_instance(&inst);
+    return ok;
 }
 
 
+/**
+ * The reference oracle of the differential test below: the original
+ * pointer-based greedy, frozen as it was before links became bitsets.
+ * Changes to the solver must never be made here.
+ */
+
 /**
  * Links all points.
  */
-void link_points() {
+void ref_link_points() {
     int i = 0;
     int j = 0;
-    for (i = 0; i < num_points; i++) {
-        mypoints[i].id = i;
-        mypoints[i].connections = malloc(sizeof (mypoint *) * MAX_POINTS);
-        for (j = 0; j < num_points; j++) {
+    for (i = 0; i < ref_num_points; i++) {
+        ref_points[i].id = i;
+        for (j = 0; j < ref_num_points; j++) {
             if (i == j) {
-                mypoints[i].connections[j] = NULL;
+                ref_points[i].connections[j] = NULL;
             }
             else {
-                mypoints[i].connections[j] = &(mypoints[j]);
-                num_edges++;
+                ref_points[i].connections[j] = &(ref_points[j]);
+                ref_num_edges++;
             }
         }
     }
-
-    if (num_edges != num_points * (num_points - 1)) {
-        printf("The number of points is incorrect");
-        exit(0);
-    }
 }
 
 /**
  * Unlinks two points
- * @param pt1 - pointer to mypoint
- * @param pt2 - pointer to mypoint
+ * @param pt1 - pointer to myrefpoint
+ * @param pt2 - pointer to myrefpoint
  */
-void unlink_points(mypoint *pt1, mypoint *pt2) {
+void ref_unlink_points(myrefpoint *pt1, myrefpoint *pt2) {
     if (pt1->connections[pt2->id] != NULL) {
         pt1->connections[pt2->id] = NULL;
         pt2->connections[pt1->id] = NULL;
-        num_edges -= 2;
-    }
-}
-
-/**
- * Frees the memory of all points' connections.
- * Re-initializes the number of points, lines, edges and all_lines.
- */
-void restore() {
-    int i = 0;
-    for (; i < num_points; i++) {
-        free(mypoints[i].connections);
+        ref_num_edges -= 2;
     }
-    num_points = 0;
-    num_lines = 0;
-    num_edges = 0;
-    num_all_lines = 0;
 }
 
-
 /**
- * Returns the index of the point closest to the left or bottom of a line,
- * which takes at most O(n) time.
+ * Returns the index of the point closest to the left or bottom of a line.
  * If there is no point to the left or bottom of the line, return -1.
  * @param ln - pointer to a line struct
  */
-int closest_point(myline *ln) {
+int ref_closest_point(myline *ln) {
     float coord = 0;
     int i = 0;
-    for (; i < num_points; i++) {
+    for (; i < ref_num_points; i++) {
         if (ln->axis == V) {
-            coord = (float)x_points[i]->x;
+            coord = (float)ref_x_points[i]->x;
         } else {
-            coord = (float)y_points[i]->y;
+            coord = (float)ref_y_points[i]->y;
         }
         if (coord > ln->coord) {
             return i - 1;
@@ -223,57 +6427,49 @@ int closest_point(myline *ln) {
 
 /**
  * Pre-separate points by using axis-parallel lines, which are not final.
- * From left to right, every two adjacent points are separated by a line whose x-coordinate
- * equals to the average of their x-coordinates.
- * From bottom to top, same lines are created.
  */
-void pre_separate() {
+void ref_pre_separate() {
     int i = 0;
     myline *v_ln;
     myline *h_ln;
-    for (; i < num_points - 1; i++) {
-        v_ln = &(all_lines[num_all_lines]);
+    for (; i < ref_num_points - 1; i++) {
+        v_ln = &(ref_all_lines[ref_num_all_lines]);
         v_ln->axis = V;
-        v_ln->coord = ((float)x_points[i]->x + (float)x_points[i + 1]->x) / 2;
-        lines[num_all_lines] = v_ln;
-        num_all_lines++;
-
+        v_ln->coord = ((float)ref_x_points[i]->x + (float)ref_x_points[i + 1]->x) / 2;
+        ref_lines[ref_num_all_lines] = v_ln;
+        ref_num_all_lines++;
     }
-    for (i = 0; i < num_points - 1; i++) {
-        h_ln = &(all_lines[num_all_lines]);
+    for (i = 0; i < ref_num_points - 1; i++) {
+        h_ln = &(ref_all_lines[ref_num_all_lines]);
         h_ln->axis = H;
-        h_ln->coord = ((float)y_points[i]->y + (float)y_points[i + 1]->y) / 2;
-        lines[num_all_lines] = h_ln;
-        num_all_lines++;
+        h_ln->coord = ((float)ref_y_points[i]->y + (float)ref_y_points[i + 1]->y) / 2;
+        ref_lines[ref_num_all_lines] = h_ln;
+        ref_num_all_lines++;
     }
 }
 
-
 /**
- * Returns the number of links that a line can break, which takes O(n^2)
- * Returns -1 if no link can be broken.
+ * Returns the number of links that a line can break.
  * @param ln - pointer to a line struct
- * @return the number of links that a line can break.
  */
-int links_to_break(myline *ln) {
+int ref_links_to_break(myline *ln) {
     if (ln == NULL) {
         return 0;
     }
 
-    mypoint **pt;
+    myrefpoint **pt;
     if (ln->axis == V) {
-        pt = x_points;
+        pt = ref_x_points;
     } else {
-        pt = y_points;
+        pt = ref_y_points;
     }
 
-    /// computes the number of links of points on different sides of the line.
-    int closest = closest_point(ln);
+    int closest = ref_closest_point(ln);
     int num_links = 0;
     int i, j;
     for (i = 0; i <= closest; i++) {
-        for (j = closest + 1; j < num_points; j++) {
-            if (mypoints[pt[i]->id].connections[pt[j]->id] != NULL) {
+        for (j = closest + 1; j < ref_num_points; j++) {
+            if (ref_points[pt[i]->id].connections[pt[j]->id] != NULL) {
                 num_links++;
             }
         }
@@ -285,90 +6481,796 @@ int links_to_break(myline *ln) {
  * Finalizes the axis-parallel lines that optimally separates points.
  * @param ln - pointer to a line struct
  */
-void finalize_lines(myline *ln) {
+void ref_finalize_lines(myline *ln) {
     if (ln == NULL) {
         return;
     }
-    final_lines[num_lines] = ln;
-    int closest = closest_point(ln);
+    ref_final_lines[ref_num_lines] = ln;
+    int closest = ref_closest_point(ln);
 
-    mypoint **pt;
+    myrefpoint **pt;
     if (ln->axis == V) {
-        pt = x_points;
+        pt = ref_x_points;
     } else {
-        pt = y_points;
+        pt = ref_y_points;
     }
 
-    /// unlinks points at the two sides of the line to be committed
     int i, j;
     for (i = 0; i <= closest; i++) {
-        for (j = closest + 1; j < num_points; j++) {
-            unlink_points(pt[i], pt[j]);
+        for (j = closest + 1; j < ref_num_points; j++) {
+            ref_unlink_points(pt[i], pt[j]);
         }
     }
-    num_lines++;
+    ref_num_lines++;
+}
+
+int ref_y_compare(const void *a, const void *b){
+    return (*(myrefpoint **)a)->y - (*(myrefpoint **)b)->y;
 }
 
 /**
- *  Compares two points' y-coordinate for the following sorting step.
+ * Solves an instance of at most REF_MAX_POINTS points, sorted by x, with the
+ * reference greedy.
+ * @param sol - receives the committed lines
  */
-int y_compare(const void *a, const void *b){
-    return (*(mypoint **)a)->y - (*(mypoint **)b)->y;
+void ref_solve(unsigned int n, const int *x, const int *y, mysolution *sol) {
+    unsigned int i = 0;
+    ref_num_points = n;
+    ref_num_edges = 0;
+    ref_num_lines = 0;
+    ref_num_all_lines = 0;
+    for (; i < n; i++) {
+        ref_points[i].x = x[i];
+        ref_points[i].y = y[i];
+        ref_x_points[i] = &(ref_points[i]);
+        ref_y_points[i] = &(ref_points[i]);
+    }
+    qsort(ref_y_points, ref_num_points, sizeof(myrefpoint *), &ref_y_compare);
+
+    ref_link_points();
+    ref_pre_separate();
+
+    while (ref_num_edges > 0) {
+        int num_link = ref_links_to_break(ref_lines[0]);
+        int line_index = 0;
+        int j;
+        for (j = 1; j < ref_num_all_lines; j++) {
+            int temp = ref_links_to_break(ref_lines[j]);
+            if (temp > num_link) {
+                line_index = j;
+                num_link = temp;
+            }
+        }
+        ref_finalize_lines(ref_lines[line_index]);
+        ref_lines[line_index] = NULL;
+    }
+
+    if (ref_num_lines > sol->capacity) {
+        sol->lines = realloc(sol->lines, sizeof (myline) * ref_num_lines);
+        if (sol->lines == NULL) {
+            printf("Out of memory\n");
+            exit(1);
+        }
+        sol->capacity = ref_num_lines;
+    }
+    sol->job = NULL;
+    sol->num_lines = ref_num_lines;
+    for (i = 0; i < ref_num_lines; i++) {
+        sol->lines[i] = *ref_final_lines[i];
+    }
 }
 
+/**
+ * Draws a point of one of the instance shapes of the differential test.
+ * Besides uniform points, the shapes pile up equal coordinates, which is
+ * where candidate lines tie, and use coordinates far from zero.
+ * @param shape - the shape of the instance
+ * @param i - the index of the point
+ * @param n - the number of points of the instance
+ */
+void random_point(int shape, unsigned int i, unsigned int n, uint64_t *rng, int *x, int *y) {
+    switch (shape) {
+        case 0:
+            /// uniform
+            *x = (int)random_below(rng, 1000);
+            *y = (int)random_below(rng, 1000);
+            break;
+        case 1:
+            /// a small grid, so most coordinates are shared
+            *x = (int)random_below(rng, 12);
+            *y = (int)random_below(rng, 12);
+            break;
+        case 2:
+            /// a diagonal with some points pushed off it
+            *x = (int)i;
+            *y = (int)i + (int)random_below(rng, 3) - 1;
+            break;
+        case 3:
+            /// an anti-diagonal
+            *x = (int)i;
+            *y = (int)(n - i);
+            break;
+        case 4:
+            /// a cross of one column and one row
+            if (random_below(rng, 2)) {
+                *x = 50;
+                *y = (int)random_below(rng, 100);
+            } else {
+                *x = (int)random_below(rng, 100);
+                *y = 50;
+            }
+            break;
+        case 5:
+            /// clusters around a few centres
+            *x = (int)(random_below(rng, 4) * 100 + random_below(rng, 5));
+            *y = (int)(random_below(rng, 4) * 100 + random_below(rng, 5));
+            break;
+        default:
+            /// negative and large coordinates, still exact as floats
+            *x = (int)random_below(rng, 1 << 24) - (1 << 23);
+            *y = (int)random_below(rng, 1 << 24) - (1 << 23);
+            break;
+    }
+}
 
-int main() {
-    printf("----------- Program starts -----------\n");
-    int file_index = 1;
-    int file_num = 0;
-    for (; file_index < MAX_POINTS; file_index++) {
-        int status = read_file(file_index);
+/**
+ * Generates an instance of distinct points sorted by x, as the input files are.
+ * @param n - the number of points wanted; receives the number generated,
+ * which is smaller if the shape has no room for more distinct points
+ */
+void random_instance(int shape, uint64_t *rng, unsigned int *n, int *x, int *y) {
+    unsigned int count = 0;
+    unsigned int tries = 0;
+    while (count < *n && tries < 100 * *n) {
+        int px, py;
+        unsigned int i = 0;
+        random_point(shape, count, *n, rng, &px, &py);
+        tries++;
+        for (; i < count && (x[i] != px || y[i] != py); i++) {
+        }
+        if (i < count) {
+            continue;
+        }
+        /// insertion by x; points with equal x stay in the order they were drawn
+        for (i = count; i > 0 && x[i - 1] > px; i--) {
+            x[i] = x[i - 1];
+            y[i] = y[i - 1];
+        }
+        x[i] = px;
+        y[i] = py;
+        count++;
+    }
+    *n = count;
+}
 
-        switch (status) {
-            case FILE_NOT_EXISTS:
-            	printf("No instance%.2d.txt found.\n", file_index);
-                continue;
+/**
+ * Solves an instance with the solver in one configuration. The cache
+ * configuration solves it twice, storing the entry and then answering from
+ * it, and removes the entry so that the next instance misses again.
+ * @param sol - receives the committed lines
+ */
+void config_solve(const myconfig *cfg, unsigned int n, const int *x, const int *y, mysolution *sol) {
+    const mykernel *saved_kernel = kernel;
+    int saved_storage = storage;
+    int saved_select = select_tree;
+    kernel = cfg->kernel;
+    storage = cfg->storage;
+    select_tree = cfg->select_tree;
+    if (cfg->pool != NULL || cfg->beam) {
+        /// the points are only read
+        myjob job = {NULL, NULL, cfg->name};
+        myinstance inst = {0};
+        inst.job = &job;
+        inst.status = FILE_SUCCESS;
+        inst.num_points = n;
+        inst.x = (int *)x;
+        inst.y = (int *)y;
+        if (cfg->pool != NULL) {
+            restart_pool = cfg->pool;
+            solve_restarts(&inst, sol);
+            restart_pool = NULL;
+        } else if (!solve_beam(&inst, sol)) {
+            sol->num_lines = 0;
+        }
+    } else {
+        int pass = 0;
+        for (; pass < (cfg->cache ? 2 : 1); pass++) {
+            load_points(n, x, y);
+            solve();
+            store_solution(NULL, sol);
+            restore();
+        }
+    }
+    if (cfg->cache) {
+        char path[4096];
+        cache_path(path, sizeof path, signature_hash, 0);
+        remove(path);
+        /// the directory of the entry is only removed once it is empty
+        *strrchr(path, '/') = '\0';
+        rmdir(path);
+    }
+    kernel = saved_kernel;
+    storage = saved_storage;
+    select_tree = saved_select;
+}
 
-            case FILE_ERROR_POINTS:
-                printf("instance%.2d.txt has incorrect number of points.\n", file_index);
-                continue;
+/**
+ * Returns the index of the first line two solutions differ in, or -1 if they
+ * are the same line for line.
+ */
+int first_difference(const mysolution *a, const mysolution *b) {
+    unsigned int i = 0;
+    for (; i < a->num_lines && i < b->num_lines; i++) {
+        if (a->lines[i].axis != b->lines[i].axis || a->lines[i].coord != b->lines[i].coord) {
+            return (int)i;
+        }
+    }
+    return a->num_lines == b->num_lines ? -1 : (int)i;
+}
+
+/**
+ * Tells whether a configuration disagrees with the reference on an instance.
+ */
+int config_differs(const myconfig *cfg, unsigned int n, const int *x, const int *y,
+                   mysolution *ref, mysolution *sol) {
+    ref_solve(n, x, y, ref);
+    config_solve(cfg, n, x, y, sol);
+    return first_difference(ref, sol) >= 0;
+}
+
+/**
+ * Shrinks an instance a configuration fails on by removing points, one at a
+ * time, as long as the configuration still disagrees with the reference.
+ * Removing points keeps them distinct and sorted by x.
+ * @param n - the number of points, updated
+ */
+void minimize_instance(const myconfig *cfg, unsigned int *n, int *x, int *y,
+                       mysolution *ref, mysolution *sol) {
+    int cx[REF_MAX_POINTS];
+    int cy[REF_MAX_POINTS];
+    int shrunk = 1;
+    while (shrunk && *n > 1) {
+        unsigned int i = 0;
+        shrunk = 0;
+        while (i < *n && *n > 1) {
+            unsigned int k = 0;
+            unsigned int m = 0;
+            for (; k < *n; k++) {
+                if (k != i) {
+                    cx[m] = x[k];
+                    cy[m] = y[k];
+                    m++;
+                }
+            }
+            if (config_differs(cfg, m, cx, cy, ref, sol)) {
+                memcpy(x, cx, sizeof (int) * m);
+                memcpy(y, cy, sizeof (int) * m);
+                *n = m;
+                shrunk = 1;
+            } else {
+                i++;
+            }
+        }
+    }
+}
+
+/**
+ * Writes an instance as an input file.
+ */
+void write_instance(const char *path, unsigned int n, const int *x, const int *y) {
+    FILE *output = fopen(path, "w");
+    unsigned int i = 0;
+    if (output == NULL) {
+        printf("Cannot write %s\n", path);
+        return;
+    }
+    fprintf(output, "%u\n", n);
+    for (; i < n; i++) {
+        fprintf(output, "%d %d\n", x[i], y[i]);
+    }
+    fclose(output);
+}
+
+/**
+ * Lists the configurations of the solver the differential test compares
+ * with the reference: every counting kernel the CPU supports with every link
+ * storage, and the INDEX storage, which uses no kernel, all picking lines
+ * from the gain tree; the fastest kernel scanning every candidate; and, with
+ * the fastest kernel, the paths that must give the greedy's lines: one
+ * restart on pools of 1, 2 and 4 threads, a beam of one state looking one
+ * line ahead, and a solution read back from the cache.
+ * @param configs - room for MAX_CONFIGS configurations
+ * @return the number of configurations
+ */
+int list_configs(myconfig *configs) {
+    static const int storages[] = {FULL, UPPER};
+    static const int pool_threads[] = {1, 2, 4};
+    int num = 0;
+    int i = 0;
+    memset(configs, 0, sizeof (myconfig) * MAX_CONFIGS);
+    for (; i < NUM_KERNELS; i++) {
+        int s = 0;
+        if (!kernels[i].supported()) {
+            continue;
+        }
+        for (; s < 2 && num < MAX_CONFIGS; s++) {
+            myconfig *cfg = &configs[num++];
+            cfg->kernel = &kernels[i];
+            cfg->storage = storages[s];
+            cfg->select_tree = 1;
+            snprintf(cfg->name, sizeof cfg->name, "%s-%s", kernels[i].name, storage_name(storages[s]));
+        }
+    }
+    if (num < MAX_CONFIGS) {
+        configs[num].kernel = kernel;
+        configs[num].storage = INDEX;
+        configs[num].select_tree = 1;
+        snprintf(configs[num].name, sizeof configs[num].name, "%s", storage_name(INDEX));
+        num++;
+    }
+    if (num < MAX_CONFIGS) {
+        configs[num] = configs[0];
+        configs[num].select_tree = 0;
+        snprintf(configs[num].name, sizeof configs[num].name, "%s-full-scan", configs[0].kernel->name);
+        num++;
+    }
+    for (i = 0; i < 3 && num < MAX_CONFIGS; i++) {
+        configs[num] = configs[0];
+        configs[num].threads = pool_threads[i];
+        snprintf(configs[num].name, sizeof configs[num].name, "restarts-1-threads-%d", pool_threads[i]);
+        num++;
+    }
+    if (num < MAX_CONFIGS) {
+        configs[num] = configs[0];
+        configs[num].beam = 1;
+        snprintf(configs[num].name, sizeof configs[num].name, "beam-1-depth-1");
+        num++;
+    }
+    if (num < MAX_CONFIGS) {
+        configs[num] = configs[0];
+        configs[num].cache = 1;
+        snprintf(configs[num].name, sizeof configs[num].name, "%s-full-cache", configs[0].kernel->name);
+        num++;
+    }
+    return num;
+}
 
-            case FILE_NO_POINTS:
-                printf("There are no points in instance%.2d.txt\n", file_index);
+/**
+ * Solves random and adversarial instances with the reference and with every
+ * configuration, and compares the committed lines one by one. Each instance a
+ * configuration fails on is minimized and written to the output directory as
+ * difftest_<configuration>_<instance>.txt, to be replayed as an input file.
+ * @param count - the number of instances
+ * @param seed - the seed of the instances
+ * @param output_dir - where failing instances go
+ * @return the number of failures
+ */
+int run_difftest(unsigned int count, uint64_t seed, const char *output_dir) {
+    myconfig configs[MAX_CONFIGS];
+    mypool pools[MAX_CONFIGS];
+    char cache[4096];
+    int num_configs = list_configs(configs);
+    mysolution ref = {0};
+    mysolution sol = {0};
+    int x[REF_MAX_POINTS];
+    int y[REF_MAX_POINTS];
+    uint64_t rng = seed;
+    unsigned int t = 0;
+    int failures = 0;
+    int p = 0;
+
+    /// the reference has no budget and solves to the end
+    budget_ms = 0;
+    max_lines = 0;
+    target_fraction = 0;
+    /// every configuration solves by the plain greedy but for its own path
+    prune = 0;
+    approx_samples = 0;
+    num_restarts = 1;
+    beam_width = 1;
+    beam_depth = 1;
+    report_solves = 0;
+    snprintf(cache, sizeof cache, "%s/difftest_cache", output_dir);
+    cache_dir = NULL;
+    for (p = 0; p < num_configs; p++) {
+        if (configs[p].threads > 0) {
+            /// a pool is kept for the whole test, so its threads carry state from one instance to the next
+            pool_init(&pools[p], configs[p].threads);
+            configs[p].pool = &pools[p];
+        }
+    }
+    printf("Difftest: %u instances, seed %llu, %d configurations.\n", count,
+           (unsigned long long)seed, num_configs);
+    for (; t < count; t++) {
+        int shape = (int)(t % NUM_SHAPES);
+        unsigned int n = 1 + random_below(&rng, REF_MAX_POINTS);
+        int c = 0;
+        random_instance(shape, &rng, &n, x, y);
+        ref_solve(n, x, y, &ref);
+        for (; c < num_configs; c++) {
+            cache_dir = configs[c].cache ? cache : NULL;
+            config_solve(&configs[c], n, x, y, &sol);
+            int diff = first_difference(&ref, &sol);
+            if (diff < 0) {
                 continue;
-            default:
-                break;
+            }
+
+            char path[4096];
+            unsigned int m = n;
+            int mx[REF_MAX_POINTS];
+            int my[REF_MAX_POINTS];
+            failures++;
+            printf("Instance %u (%u points, shape %d): %s differs from the reference at line %d.\n",
+                   t, n, shape, configs[c].name, diff + 1);
+            memcpy(mx, x, sizeof (int) * n);
+            memcpy(my, y, sizeof (int) * n);
+            minimize_instance(&configs[c], &m, mx, my, &ref, &sol);
+            snprintf(path, sizeof path, "%s/difftest_%s_%u.txt", output_dir, configs[c].name, t);
+            write_instance(path, m, mx, my);
+            printf("Minimized to %u points in %s\n", m, path);
+            ref_solve(n, x, y, &ref);
         }
+    }
+    cache_dir = NULL;
+    rmdir(cache);
+    for (p = 0; p < num_configs; p++) {
+        if (configs[p].pool != NULL) {
+            pool_destroy(configs[p].pool);
+        }
+    }
+    free(ref.lines);
+    free(sol.lines);
+    printf("Difftest: %d failures.\n", failures);
+    return failures;
+}
+
+/**
+ * Prints the command line options.
+ */
+void usage(const char *prog) {
+    printf("Usage: %s [--kernel=NAME] [--storage=full|upper|index] [--select=tree|scan]\n", prog);
+    printf("          [--pipeline[=DEPTH]]\n");
+    printf("          [--input-dir=DIR | --glob=PATTERN | --manifest=FILE] [--output-dir=DIR]\n");
+    printf("          [--pack=FILE | --container=FILE [--container-out=FILE] | --unpack=FILE]\n");
+    printf("          [--cache=DIR] [--verify[=INSTANCE,SOLUTION]] [--difftest[=COUNT]] [--seed=SEED]\n");
+    printf("          [--prune] [--budget-ms=MS] [--restarts=K [--near-max=EPS]] [--exact[=N]] [--threads=N]\n");
+    printf("          [--bound] [--max-lines=K | --target-fraction=F]\n");
+    printf("          [--coarse[=G] [--coarse-cell=M] [--coarse-compare]] [--approx[=S] [--approx-error=E]]\n");
+    printf("          [--beam[=B] [--beam-depth=D]] [--improve=MS] [--improve-moves=K]\n");
+    printf("          [--updates=INSTANCE,UPDATES [--resolve-threshold=F]] [--query=INSTANCE,SOLUTION,QUERIES]\n");
+    printf("  --kernel=NAME  forces a counting kernel:");
+    int i = 0;
+    for (; i < NUM_KERNELS; i++) {
+        printf(" %s", kernels[i].name);
+    }
+    printf("\n");
+    printf("  --storage=full|upper|index  stores every pair of links twice (default), or once,\n");
+    printf("                    or counts linked pairs per cell from a range-count index of the points\n");
+    printf("  --select=tree|scan  picks each line from a tree of gain bounds, evaluating few candidates\n");
+    printf("                    (default), or by evaluating every candidate\n");
+    printf("  --pipeline[=DEPTH]  reads up to DEPTH (default 2) instances ahead and writes\n");
+    printf("                      solutions on separate threads while solving\n");
+    printf("  --input-dir=DIR  solves every instance*.txt in DIR (default input)\n");
+    printf("  --glob=PATTERN   solves every file matching PATTERN\n");
+    printf("  --manifest=FILE  solves the files listed in FILE, one \"input output\" pair per line\n");
+    printf("  --output-dir=DIR  where solutions of --input-dir and --glob go (default output_greedy)\n");
+    printf("  --pack=FILE       packs the instances found into one container instead of solving them\n");
+    printf("  --container=FILE  solves every instance of a container into a solution container,\n");
+    printf("                    --container-out (default FILE.solutions)\n");
+    printf("  --unpack=FILE     writes the solutions of a solution container as text files into --output-dir\n");
+    printf("  --cache=DIR       reuses the solutions of instances with the same rank signature\n");
+    printf("  --verify          checks the existing solutions of the instances found instead of solving them\n");
+    printf("  --verify=INSTANCE,SOLUTION  checks one solution file\n");
+    printf("  --difftest[=COUNT]  compares every solver configuration with the reference greedy on\n");
+    printf("                      COUNT (default 1000) random instances; failing instances are\n");
+    printf("                      minimized into --output-dir\n");
+    printf("  --seed=SEED       seeds the random instances and restarts (default 1)\n");
+    printf("  --prune           removes the lines the other lines of a solution make redundant\n");
+    printf("  --budget-ms=MS    stops the greedy of an instance after MS milliseconds and cuts the\n");
+    printf("                    points still sharing a cell with one line per neighbouring pair\n");
+    printf("  --restarts=K      solves every instance K times, breaking ties at random but for the\n");
+    printf("                    first time, and keeps the solution with the fewest lines\n");
+    printf("  --near-max=EPS    lets restarts pick lines breaking at least (1 - EPS) times the most links\n");
+    printf("  --exact[=N]       finds the fewest lines for instances of up to N (default 30) points,\n");
+    printf("                    starting from the greedy solution; --budget-ms also bounds this search\n");
+    printf("  --threads=N       runs restarts and the exact search on N threads (default: one per core)\n");
+    printf("  --bound           reports every solution with its gap to a lower bound on the lines needed\n");
+    printf("  --max-lines=K     stops the greedy after K lines, leaving points sharing cells\n");
+    printf("  --target-fraction=F  stops the greedy once a fraction F of the pairs of points is separated\n");
+    printf("  --coarse[=G]      solves in two levels: the greedy on a GxG grid of buckets (default about\n");
+    printf("                    16 points per bucket), then in each cell still holding several points\n");
+    printf("  --coarse-cell=M   stops the grid level once no boundary separates M^2/4 pairs (default 1024)\n");
+    printf("  --coarse-compare  also runs the flat greedy and reports both lines and times\n");
+    printf("  --approx[=S]      estimates the gains of the candidates from S (default 256) random points,\n");
+    printf("                    evaluating exactly only when the estimates are too close to tell; more\n");
+    printf("                    points cost time and confirm less often (full and index storage)\n");
+    printf("  --approx-error=E  the fraction of the best gain a line picked from estimates may give up\n");
+    printf("                    (default 0.05); 0 picks the best line almost always\n");
+    printf("  --beam[=B]        solves by a beam search keeping B states (default 4) on --threads threads;\n");
+    printf("                    wider beams and deeper lookahead cost time and may save lines\n");
+    printf("  --beam-depth=D    scores every step of the beam by D - 1 greedy lines after it, or by the\n");
+    printf("                    greedy until all points are separated with 0 (the default)\n");
+    printf("  --improve=MS      improves every solution by local search for MS milliseconds, dropping\n");
+    printf("                    lines, merging two lines into one and swapping lines (seeded by --seed)\n");
+    printf("  --improve-moves=K stops the local search after K moves, which gives the same lines anywhere\n");
+    printf("  --updates=INSTANCE,UPDATES  solves INSTANCE, applies the updates \"+ x y\" (insert) and \"- x y\"\n");
+    printf("                    (delete) by repairing its lines, and writes the solution into --output-dir\n");
+    printf("  --resolve-threshold=F  solves again once the lines grew by F (default 0.1) since the last solve\n");
+    printf("  --query=INSTANCE,SOLUTION,QUERIES  answers, for every \"x y\" of QUERIES, the cell of the solution\n");
+    printf("                    holding (x, y) and the point owning it, into --output-dir\n");
+}
 
-        /// Sort the points by y-coordinate. Points are pre-sorted by x-coordinate.
-        qsort(y_points, num_points, sizeof(mypoint *), &y_compare);
 
-        link_points();
-        pre_separate();
-
-        while (num_edges > 0) {
-            /// Finds the line that can break the most links.
-            int num_link = links_to_break(lines[0]);
-            int line_index = 0;
-            int j;
-            for (j = 1; j < num_all_lines; j++) {
-                int temp = links_to_break(lines[j]);
-                if (temp > num_link) {
-                    line_index = j;
-                    num_link = temp;
-                }
+int main(int argc, char *argv[]) {
+    const char *kernel_name = NULL;
+    int pipeline_depth = 0;
+    const char *input_dir = "input";
+    const char *output_dir = "output_greedy";
+    const char *pattern = NULL;
+    const char *manifest = NULL;
+    const char *pack = NULL;
+    const char *container = NULL;
+    const char *container_out = NULL;
+    const char *unpack = NULL;
+    const char *verify = NULL;
+    const char *updates = NULL;
+    const char *query = NULL;
+    double resolve_threshold = 0.1;
+    int difftest = 0;
+    uint64_t seed = 1;
+    mypool pool;
+    int arg = 1;
+    num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (; arg < argc; arg++) {
+        if (strncmp(argv[arg], "--kernel=", 9) == 0) {
+            kernel_name = argv[arg] + 9;
+        } else if (strcmp(argv[arg], "--storage=full") == 0) {
+            storage = FULL;
+        } else if (strcmp(argv[arg], "--storage=upper") == 0) {
+            storage = UPPER;
+        } else if (strcmp(argv[arg], "--storage=index") == 0) {
+            storage = INDEX;
+        } else if (strcmp(argv[arg], "--select=tree") == 0) {
+            select_tree = 1;
+        } else if (strcmp(argv[arg], "--select=scan") == 0) {
+            select_tree = 0;
+        } else if (strcmp(argv[arg], "--pipeline") == 0) {
+            pipeline_depth = 2;
+        } else if (strncmp(argv[arg], "--pipeline=", 11) == 0 && atoi(argv[arg] + 11) > 0) {
+            pipeline_depth = atoi(argv[arg] + 11);
+        } else if (strncmp(argv[arg], "--input-dir=", 12) == 0) {
+            input_dir = argv[arg] + 12;
+        } else if (strncmp(argv[arg], "--output-dir=", 13) == 0) {
+            output_dir = argv[arg] + 13;
+        } else if (strncmp(argv[arg], "--glob=", 7) == 0) {
+            pattern = argv[arg] + 7;
+        } else if (strncmp(argv[arg], "--manifest=", 11) == 0) {
+            manifest = argv[arg] + 11;
+        } else if (strncmp(argv[arg], "--pack=", 7) == 0) {
+            pack = argv[arg] + 7;
+        } else if (strncmp(argv[arg], "--container=", 12) == 0) {
+            container = argv[arg] + 12;
+        } else if (strncmp(argv[arg], "--container-out=", 16) == 0) {
+            container_out = argv[arg] + 16;
+        } else if (strncmp(argv[arg], "--unpack=", 9) == 0) {
+            unpack = argv[arg] + 9;
+        } else if (strncmp(argv[arg], "--cache=", 8) == 0) {
+            cache_dir = argv[arg] + 8;
+        } else if (strncmp(argv[arg], "--budget-ms=", 12) == 0 && atol(argv[arg] + 12) > 0) {
+            budget_ms = atol(argv[arg] + 12);
+        } else if (strncmp(argv[arg], "--restarts=", 11) == 0 && atoi(argv[arg] + 11) > 0) {
+            num_restarts = atoi(argv[arg] + 11);
+        } else if (strncmp(argv[arg], "--near-max=", 11) == 0) {
+            near_max = atof(argv[arg] + 11);
+        } else if (strncmp(argv[arg], "--threads=", 10) == 0 && atoi(argv[arg] + 10) > 0) {
+            num_threads = atoi(argv[arg] + 10);
+        } else if (strcmp(argv[arg], "--exact") == 0) {
+            exact_max = EXACT_DEFAULT_MAX;
+        } else if (strncmp(argv[arg], "--exact=", 8) == 0 && atoi(argv[arg] + 8) > 0) {
+            exact_max = (unsigned int)atoi(argv[arg] + 8);
+        } else if (strncmp(argv[arg], "--max-lines=", 12) == 0 && atoi(argv[arg] + 12) > 0) {
+            max_lines = (unsigned int)atoi(argv[arg] + 12);
+        } else if (strncmp(argv[arg], "--target-fraction=", 18) == 0 && atof(argv[arg] + 18) > 0) {
+            target_fraction = atof(argv[arg] + 18);
+        } else if (strcmp(argv[arg], "--approx") == 0) {
+            approx_samples = 256;
+        } else if (strncmp(argv[arg], "--approx=", 9) == 0 && atoi(argv[arg] + 9) > 0) {
+            approx_samples = (unsigned int)atoi(argv[arg] + 9);
+        } else if (strncmp(argv[arg], "--approx-error=", 15) == 0 && atof(argv[arg] + 15) >= 0
+                   && atof(argv[arg] + 15) < 1) {
+            approx_error = atof(argv[arg] + 15);
+        } else if (strcmp(argv[arg], "--coarse") == 0) {
+            coarse = 1;
+        } else if (strncmp(argv[arg], "--coarse=", 9) == 0 && atoi(argv[arg] + 9) > 1) {
+            coarse = 1;
+            coarse_grid = (unsigned int)atoi(argv[arg] + 9);
+        } else if (strncmp(argv[arg], "--coarse-cell=", 14) == 0 && atoi(argv[arg] + 14) > 0) {
+            coarse_cell = (unsigned int)atoi(argv[arg] + 14);
+        } else if (strcmp(argv[arg], "--beam") == 0) {
+            beam_width = 4;
+        } else if (strncmp(argv[arg], "--beam=", 7) == 0 && atoi(argv[arg] + 7) > 0) {
+            beam_width = (unsigned int)atoi(argv[arg] + 7);
+        } else if (strncmp(argv[arg], "--beam-depth=", 13) == 0 && atoi(argv[arg] + 13) >= 0) {
+            beam_depth = (unsigned int)atoi(argv[arg] + 13);
+        } else if (strncmp(argv[arg], "--improve=", 10) == 0 && atol(argv[arg] + 10) > 0) {
+            improve_ms = atol(argv[arg] + 10);
+        } else if (strncmp(argv[arg], "--improve-moves=", 16) == 0 && atoll(argv[arg] + 16) > 0) {
+            improve_moves = (unsigned long long)atoll(argv[arg] + 16);
+        } else if (strcmp(argv[arg], "--coarse-compare") == 0) {
+            coarse_compare = 1;
+        } else if (strcmp(argv[arg], "--bound") == 0) {
+            report_bounds = 1;
+        } else if (strcmp(argv[arg], "--prune") == 0) {
+            prune = 1;
+        } else if (strcmp(argv[arg], "--difftest") == 0) {
+            difftest = 1000;
+        } else if (strncmp(argv[arg], "--difftest=", 11) == 0 && atoi(argv[arg] + 11) > 0) {
+            difftest = atoi(argv[arg] + 11);
+        } else if (strncmp(argv[arg], "--seed=", 7) == 0) {
+            seed = strtoull(argv[arg] + 7, NULL, 10);
+        } else if (strncmp(argv[arg], "--updates=", 10) == 0 && strchr(argv[arg] + 10, ',') != NULL) {
+            updates = argv[arg] + 10;
+        } else if (strncmp(argv[arg], "--query=", 8) == 0 && strchr(argv[arg] + 8, ',') != NULL
+                   && strchr(strchr(argv[arg] + 8, ',') + 1, ',') != NULL) {
+            query = argv[arg] + 8;
+        } else if (strncmp(argv[arg], "--resolve-threshold=", 20) == 0 && atof(argv[arg] + 20) >= 0) {
+            resolve_threshold = atof(argv[arg] + 20);
+        } else if (strcmp(argv[arg], "--verify") == 0) {
+            verify = "";
+        } else if (strncmp(argv[arg], "--verify=", 9) == 0 && strchr(argv[arg] + 9, ',') != NULL) {
+            verify = argv[arg] + 9;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    kernel = select_kernel(kernel_name);
+    if (kernel == NULL) {
+        printf("Kernel %s is unknown or not supported by this CPU.\n", kernel_name);
+        return 1;
+    }
+
+    printf("----------- Program starts -----------\n");
+    printf("Counting kernel: %s\n", kernel->name);
+    printf("Link storage: %s\n", storage_name(storage));
+    restart_seed = seed;
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_restarts > 1 && difftest == 0 && updates == NULL && query == NULL) {
+        pool_init(&pool, num_threads < num_restarts ? num_threads : num_restarts);
+        restart_pool = &pool;
+        printf("Restarts: %d on %d threads.\n", num_restarts, pool.num_threads);
+    } else if (beam_width > 0 && num_threads > 1 && difftest == 0 && updates == NULL && query == NULL) {
+        /// the beam expands its states on the pool of the restarts
+        pool_init(&pool, num_threads < (int)beam_width ? num_threads : (int)beam_width);
+        restart_pool = &pool;
+        printf("Beam: %u states on %d threads.\n", beam_width, pool.num_threads);
+    }
+
+    int file_num;
+    if (difftest > 0) {
+        mkdir(output_dir, 0755);
+        file_num = run_difftest((unsigned int)difftest, seed, output_dir);
+        printf("----------- Program ends -----------\n");
+        return file_num > 0;
+    }
+    if (updates != NULL) {
+        mkdir(output_dir, 0755);
+        file_num = run_updates(updates, output_dir, resolve_threshold);
+        free_jobs();
+        printf("----------- Program ends -----------\n");
+        return !file_num;
+    }
+    if (query != NULL) {
+        mkdir(output_dir, 0755);
+        file_num = run_queries(query, output_dir);
+        free_jobs();
+        printf("----------- Program ends -----------\n");
+        return !file_num;
+    }
+    if (container != NULL || unpack != NULL) {
+        char *default_out = NULL;
+        if (container != NULL) {
+            if (container_out == NULL) {
+                default_out = malloc(strlen(container) + 16);
+                sprintf(default_out, "%s.solutions", container);
+                container_out = default_out;
             }
-            finalize_lines(lines[line_index]);
-            lines[line_index] = NULL;
+            file_num = run_container(container, container_out);
+        } else {
+            mkdir(output_dir, 0755);
+            file_num = unpack_solutions(unpack, output_dir);
+        }
+        free(default_out);
+        free_jobs();
+        if (restart_pool != NULL) {
+            pool_destroy(restart_pool);
+        }
+        if (file_num >= 0) {
+            printf("%d %s done.\n", file_num, container != NULL ? "instances" : "solutions");
+        }
+        if (prune && container != NULL) {
+            printf("Pruned %u lines.\n", num_pruned);
+        }
+        if (budget_ms > 0 && container != NULL) {
+            printf("%u instances ran out of time.\n", num_out_of_time);
+        }
+        if (report_bounds && container != NULL) {
+            printf("Gap to the lower bounds: %lu lines over %u instances.\n", total_gap, num_bounded);
+        }
+        if (cache_dir != NULL) {
+            printf("Cache: %u hits, %u misses.\n", cache_hits, cache_misses);
         }
+        printf("----------- Program ends -----------\n");
+        return file_num < 0;
+    }
 
-        write_file(file_index);
-        
-        restore();
-        file_num++;
+    int found;
+    if (verify != NULL && *verify != '\0') {
+        char *instance = strdup(verify);
+        char *comma = strchr(instance, ',');
+        *comma = '\0';
+        add_job(instance, comma + 1);
+        free(instance);
+        found = 1;
+    } else if (manifest != NULL) {
+        found = read_manifest(manifest);
+    } else if (pattern != NULL) {
+        found = find_glob(pattern, output_dir);
+    } else {
+        found = find_dir(input_dir, output_dir);
+    }
+    if (manifest == NULL && pack == NULL && verify == NULL) {
+        /// creates the output directory if it is missing
+        mkdir(output_dir, 0755);
+    }
+    if (!found) {
+        printf("----------- Program ends -----------\n");
+        return 1;
+    }
+    if (verify != NULL) {
+        file_num = run_verify();
+        printf("%d of %u solutions valid.\n", file_num, num_jobs);
+        file_num = file_num == (int)num_jobs;
+        free_jobs();
+        printf("----------- Program ends -----------\n");
+        return !file_num;
+    }
+    if (pack != NULL) {
+        file_num = pack_jobs(pack);
+        if (file_num >= 0) {
+            printf("%d instances packed into %s.\n", file_num, pack);
+        }
+        free_jobs();
+        printf("----------- Program ends -----------\n");
+        return file_num < 0;
+    }
+    if (pipeline_depth > 0) {
+        file_num = run_pipeline(pipeline_depth);
+    } else {
+        file_num = run_sequential();
+    }
+    if (restart_pool != NULL) {
+        pool_destroy(restart_pool);
     }
     printf("%d files done.\n", file_num);
+    if (prune) {
+        printf("Pruned %u lines.\n", num_pruned);
+    }
+    if (budget_ms > 0) {
+        printf("%u instances ran out of time.\n", num_out_of_time);
+    }
+    if (report_bounds) {
+        printf("Gap to the lower bounds: %lu lines over %u instances.\n", total_gap, num_bounded);
+    }
+    if (cache_dir != NULL) {
+        printf("Cache: %u hits, %u misses.\n", cache_hits, cache_misses);
+    }
+    printf("Arena: %lu bytes after %u allocations.\n", (unsigned long)arena.size, arena.num_mallocs);
     printf("No more input files.\n");
+    free_jobs();
     printf("----------- Program ends -----------\n");
 }
 